@@ -26,6 +26,7 @@
 
 #include <QFileDialog>
 #include <QLabel>
+#include <QLoggingCategory>
 #include <QProcess>
 #include <QStringBuilder>
 #include <QTextCodec>
@@ -40,6 +41,9 @@
 
 using namespace SubtitleComposer;
 
+// memory saved by compact line text storage, enable with QT_LOGGING_RULES="subtitlecomposer.memory.debug=true"
+Q_LOGGING_CATEGORY(memoryLog, "subtitlecomposer.memory", QtWarningMsg)
+
 static const QStringList videoExtensionList = {
 	$("avi"), $("divx"), $("flv"), $("m2ts"), $("mkv"), $("mov"), $("mp4"), $("mpeg"),
 	$("mpg"), $("ogm"), $("ogv"), $("rmvb"), $("ts"), $("vob"), $("webm"), $("wmv"),
@@ -269,6 +273,12 @@ Application::processSubtitleOpened(QTextCodec *codec, const QString &subtitleFor
 
 	m_labSubFormat->setText(i18n("Format: %1", m_subtitleFormat));
 	m_labSubEncoding->setText(i18n("Encoding: %1", m_subtitleEncoding));
+
+	// arguments are evaluated only when the category is enabled
+	if(const int lines = appSubtitle()->count()) {
+		qCDebug(memoryLog) << "Compact text storage saves" << appSubtitle()->compactMemorySaved() / lines
+			<< "bytes per line of" << lines << "lines";
+	}
 }
 
 void
@@ -71,11 +71,22 @@ private:
 
 const RichStyle RichStyle::s_null(0, 0, 0, -1);
 
+/**
+ * @brief Styles of RichString characters stored as spans of characters sharing the same style
+ *
+ * Spans are sorted by start, first one starts at 0 and each one lasts until the next one.
+ * Neighbouring spans always have different styles.
+ */
 class RichStringStyle {
 	friend QDataStream & ::operator<<(QDataStream &stream, const SubtitleComposer::RichString &string);
 	friend QDataStream & ::operator>>(QDataStream &stream, SubtitleComposer::RichString &string);
 
 public:
+	struct Span {
+		int start;
+		RichStyle style;
+	};
+
 	RichStringStyle(int len);
 	RichStringStyle(int len, quint8 styleFlags, QRgb styleColor, const QString &klass, const QString &voice);
 	RichStringStyle(int len, quint8 styleFlags, QRgb styleColor, const QSet<QString> &classList, const QString &voice);
@@ -94,8 +105,16 @@ public:
 	inline QString className(int index) const { return m_classList.at(index); }
 	inline int classCount() const { return m_classList.size(); }
 
-	inline RichStyle * operator[](int index) { Q_ASSERT(index >= 0 && index < m_length); return &m_style[index]; }
-	inline const RichStyle & at(int index) const { return index >= 0 && index < m_length ? m_style[index] : RichStyle::s_null; }
+	inline int length() const { return m_length; }
+	inline int spanCount() const { return m_spans.size(); }
+	inline const Span & span(int spanIndex) const { return m_spans.at(spanIndex); }
+	inline int spanEnd(int spanIndex) const { return spanIndex + 1 < m_spans.size() ? m_spans.at(spanIndex + 1).start : m_length; }
+	/**
+	 * @brief Index of span that contains character at index
+	 */
+	int spanAt(int index) const;
+
+	inline const RichStyle & at(int index) const { return index >= 0 && index < m_length ? m_spans.at(spanAt(index)).style : RichStyle::s_null; }
 
 	/**
 	 * @brief Insert invalid style for len characters at index
@@ -112,8 +131,13 @@ public:
 	 */
 	void replace(int index, int len, int newLen);
 
-	inline void fill(int index, int len, const RichStyle &style);
+	inline void fill(int index, int len, const RichStyle style);
 	void copy(int index, int len, const RichStringStyle &src, int srcOffset=0);
+	/**
+	 * @brief Call func on style of each span covering len characters at index
+	 */
+	template<class Func>
+	void modify(int index, int len, Func func);
 
 	void swap(RichStringStyle &other, bool swapLists);
 
@@ -122,15 +146,15 @@ public:
 	inline void richText(QString &out, int prevIndex, int curIndex, bool opening);
 
 private:
-	void detach();
-	void updateCapacity();
+	int split(int index);
+	void mergeAt(int spanIndex);
+	void append(int len, const RichStyle &style);
 
 private:
 	QVector<QString> m_classList;
 	QVector<QString> m_voiceList;
-	RichStyle *m_style;
+	QVector<Span> m_spans;
 	int m_length;
-	int m_capacity;
 };
 
 struct ReplaceHelper {
@@ -157,56 +181,123 @@ struct ReplaceHelper {
 };
 }
 
+int
+RichStringStyle::spanAt(int index) const
+{
+	Q_ASSERT(index >= 0 && index < m_length);
+	int first = 0;
+	int last = m_spans.size() - 1;
+	while(first < last) {
+		const int mid = (first + last + 1) / 2;
+		if(m_spans.at(mid).start <= index)
+			first = mid;
+		else
+			last = mid - 1;
+	}
+	return first;
+}
+
+int
+RichStringStyle::split(int index)
+{
+	if(index >= m_length)
+		return m_spans.size();
+	const int i = spanAt(index);
+	if(m_spans.at(i).start == index)
+		return i;
+	const RichStyle style = m_spans.at(i).style;
+	m_spans.insert(i + 1, Span{index, style});
+	return i + 1;
+}
+
+void
+RichStringStyle::mergeAt(int spanIndex)
+{
+	if(spanIndex > 0 && spanIndex < m_spans.size() && m_spans.at(spanIndex - 1).style == m_spans.at(spanIndex).style)
+		m_spans.remove(spanIndex);
+}
+
+void
+RichStringStyle::append(int len, const RichStyle &style)
+{
+	if(len <= 0)
+		return;
+	if(m_spans.isEmpty() || !(m_spans.constLast().style == style))
+		m_spans.push_back(Span{m_length, style});
+	m_length += len;
+}
+
 void
 RichStringStyle::replace(int index, int lenRemove, int lenAdd)
 {
 	Q_ASSERT(index + lenRemove <= m_length);
-	const int tailLength = m_length - index - lenRemove;
 
-	RichStyle *oldStyle = m_style;
+	const int first = split(index);
+	const int last = split(index + lenRemove);
+	m_spans.erase(m_spans.begin() + first, m_spans.begin() + last);
 
-	detach();
-	m_length += lenAdd - lenRemove;
-	updateCapacity();
-
-	if(index) {
-		// restore data before inserted part
-		memcpy(m_style, oldStyle, index * sizeof(*m_style));
-	}
-	if(tailLength) {
-		// restore data after inserted part
-		const int tailStart = index + lenAdd;
-		const int tailStartOld = index + lenRemove;
-		memcpy(m_style + tailStart, oldStyle + tailStartOld, tailLength * sizeof(*m_style));
+	if(const int shift = lenAdd - lenRemove) {
+		for(int i = first, n = m_spans.size(); i < n; i++)
+			m_spans[i].start += shift;
+		m_length += shift;
 	}
 
-	delete[] oldStyle;
+	if(lenAdd) {
+		m_spans.insert(first, Span{index, RichStyle::s_null});
+		mergeAt(first + 1);
+	}
+	mergeAt(first);
 }
 
 inline void
-RichStringStyle::fill(int index, int len, const RichStyle &style)
+RichStringStyle::fill(int index, int len, const RichStyle style)
 {
 	Q_ASSERT(index + len <= m_length);
-	if(len) {
-		RichStyle *s = m_style + index;
-		const RichStyle *e = s + len;
-		while(s != e)
-			*s++ = style;
-	}
+	if(len <= 0)
+		return;
+
+	const int first = split(index);
+	const int last = split(index + len);
+	m_spans[first].style = style;
+	if(last > first + 1)
+		m_spans.erase(m_spans.begin() + first + 1, m_spans.begin() + last);
+	mergeAt(first + 1);
+	mergeAt(first);
 }
 
+template<class Func>
 void
-RichStringStyle::copy(int index, int len, const RichStringStyle &src, int srcOffset)
+RichStringStyle::modify(int index, int len, Func func)
 {
 	Q_ASSERT(index + len <= m_length);
 	if(len <= 0)
 		return;
 
+	const int first = split(index);
+	const int last = split(index + len);
+	for(int i = first; i < last; i++)
+		func(m_spans[i].style);
+	for(int i = qMin(last, int(m_spans.size()) - 1); i >= first; i--)
+		mergeAt(i);
+}
+
+void
+RichStringStyle::copy(int index, int len, const RichStringStyle &src, int srcOffset)
+{
+	Q_ASSERT(index + len <= m_length);
+	if(len <= 0 || (&src == this && index == srcOffset))
+		return;
+
+	const int srcEnd = srcOffset + len;
+
 	if(index == 0 && len == m_length) {
 		// overwrite everything
+		QVector<Span> spans;
+		for(int i = src.spanAt(srcOffset), n = src.m_spans.size(); i < n && src.m_spans.at(i).start < srcEnd; i++)
+			spans.push_back(Span{qMax(src.m_spans.at(i).start, srcOffset) - srcOffset, src.m_spans.at(i).style});
 		m_voiceList = src.m_voiceList;
 		m_classList = src.m_classList;
-		memcpy(m_style, src.m_style + srcOffset, len * sizeof(*m_style));
+		m_spans.swap(spans);
 		return;
 	}
 
@@ -219,8 +310,10 @@ RichStringStyle::copy(int index, int len, const RichStringStyle &src, int srcOff
 	int *voiceMap = new int[nv];
 	for(int i = 0; i < nv; i++)
 		voiceMap[i] = voiceIndex(src.m_voiceList[i]);
-	for(int i = 0; i < len; i++) {
-		const RichStyle &ss = src.m_style[srcOffset + i];
+	// collect remapped spans first - src can be this
+	QVector<Span> spans;
+	for(int i = src.spanAt(srcOffset), n = src.m_spans.size(); i < n && src.m_spans.at(i).start < srcEnd; i++) {
+		const RichStyle &ss = src.m_spans.at(i).style;
 		quint64 klass = 0;
 		for(int ci = 0; ci < nc; ci++) {
 			if(classMap[ci] < 0)
@@ -230,10 +323,15 @@ RichStringStyle::copy(int index, int len, const RichStringStyle &src, int srcOff
 		}
 		Q_ASSERT(ss.voice() < nv);
 		qint32 voice = ss.voice() < 0 ? -1 : voiceMap[ss.voice()];
-		m_style[index + i] = RichStyle(ss.flags(), ss.color(), klass, voice);
+		spans.push_back(Span{index + qMax(src.m_spans.at(i).start, srcOffset) - srcOffset, RichStyle(ss.flags(), ss.color(), klass, voice)});
 	}
 	delete[] voiceMap;
 	delete[] classMap;
+
+	for(int i = 0, n = spans.size(); i < n; i++) {
+		const int end = i + 1 < n ? spans.at(i + 1).start : index + len;
+		fill(spans.at(i).start, end - spans.at(i).start, spans.at(i).style);
+	}
 }
 
 void
@@ -242,8 +340,8 @@ RichStringStyle::removeUnused()
 	const int nv = m_voiceList.size();
 	int *voiceMap = new int[nv]();
 	int voiceUsed = 0;
-	for(int i = 0; i < m_length; i++) {
-		const qint32 v = m_style[i].voice();
+	for(int i = 0, n = m_spans.size(); i < n; i++) {
+		const qint32 v = m_spans.at(i).style.voice();
 		if(v >= 0) {
 			if(!voiceMap[v]) {
 #if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
@@ -254,7 +352,7 @@ RichStringStyle::removeUnused()
 #endif
 				voiceMap[v] = ++voiceUsed;
 			}
-			m_style[i].voice() = voiceMap[v] - 1;
+			m_spans[i].style.voice() = voiceMap[v] - 1;
 		}
 	}
 	m_voiceList.resize(voiceUsed);
@@ -263,16 +361,16 @@ RichStringStyle::removeUnused()
 	int *classMap = new int[nc]();
 	int classUsed = 0;
 	quint64 prevClass = 0;
-	for(int i = 0; i < m_length; i++) {
-		quint64 c = m_style[i].klass();
+	for(int i = 0, n = m_spans.size(); i < n; i++) {
+		quint64 c = m_spans.at(i).style.klass();
 		if(!c)
 			continue;
 		if(i && c == prevClass) {
-			m_style[i].klass() = m_style[i - 1].klass();
+			m_spans[i].style.klass() = m_spans.at(i - 1).style.klass();
 			continue;
 		}
 		prevClass = c;
-		m_style[i].klass() = 0;
+		m_spans[i].style.klass() = 0;
 		for(int k = 0; c; k++, c >>= 1) {
 			if(!(c & 1))
 				continue;
@@ -285,7 +383,7 @@ RichStringStyle::removeUnused()
 #endif
 				classMap[k] = ++classUsed;
 			}
-			m_style[i].klass() |= 1ULL << (classMap[k] - 1);
+			m_spans[i].style.klass() |= 1ULL << (classMap[k] - 1);
 		}
 	}
 	m_classList.resize(classUsed);
@@ -295,33 +393,23 @@ RichStringStyle::removeUnused()
 }
 
 RichStringStyle::RichStringStyle(int len)
-	: m_style(nullptr),
-	  m_length(len),
-	  m_capacity(0)
+	: m_length(0)
 {
-	if(m_length)
-		updateCapacity();
+	append(len, RichStyle::s_null);
 }
 
 RichStringStyle::RichStringStyle(int len, quint8 styleFlags, QRgb styleColor, const QString &klass, const QString &voice)
-	: m_style(nullptr),
-	  m_length(len),
-	  m_capacity(0)
+	: m_length(0)
 {
 	if(!klass.isEmpty())
 		m_classList.append(klass);
 	if(!voice.isEmpty())
 		m_voiceList.append(voice);
-	if(m_length) {
-		updateCapacity();
-		fill(0, m_length, RichStyle(quint8(styleFlags & RichString::AllStyles), styleColor, m_classList.size(), m_voiceList.size() - 1));
-	}
+	append(len, RichStyle(quint8(styleFlags & RichString::AllStyles), styleColor, m_classList.size(), m_voiceList.size() - 1));
 }
 
 RichStringStyle::RichStringStyle(int len, quint8 styleFlags, QRgb styleColor, const QSet<QString> &classList, const QString &voice)
-	: m_style(nullptr),
-	  m_length(len),
-	  m_capacity(0)
+	: m_length(0)
 {
 	quint64 classMap = 0;
 	for(const QString &klass: classList) {
@@ -331,28 +419,19 @@ RichStringStyle::RichStringStyle(int len, quint8 styleFlags, QRgb styleColor, co
 	}
 	if(!voice.isEmpty())
 		m_voiceList.append(voice);
-	if(m_length) {
-		updateCapacity();
-		fill(0, m_length, RichStyle(quint8(styleFlags & RichString::AllStyles), styleColor, classMap, m_voiceList.size() - 1));
-	}
+	append(len, RichStyle(quint8(styleFlags & RichString::AllStyles), styleColor, classMap, m_voiceList.size() - 1));
 }
 
 RichStringStyle::RichStringStyle(const RichStringStyle &other)
 	: m_classList(other.m_classList),
 	  m_voiceList(other.m_voiceList),
-	  m_style(nullptr),
-	  m_length(other.m_length),
-	  m_capacity(0)
+	  m_spans(other.m_spans),
+	  m_length(other.m_length)
 {
-	if(m_length) {
-		updateCapacity();
-		memcpy(m_style, other.m_style, m_length * sizeof(*m_style));
-	}
 }
 
 RichStringStyle::~RichStringStyle()
 {
-	delete[] m_style;
 }
 
 void
@@ -360,8 +439,8 @@ RichStringStyle::clear()
 {
 	m_classList.clear();
 	m_voiceList.clear();
+	m_spans.clear();
 	m_length = 0;
-	updateCapacity();
 }
 
 RichStringStyle &
@@ -369,10 +448,8 @@ RichStringStyle::operator=(const RichStringStyle &other)
 {
 	m_classList = other.m_classList;
 	m_voiceList = other.m_voiceList;
+	m_spans = other.m_spans;
 	m_length = other.m_length;
-	updateCapacity();
-	if(m_length)
-		memcpy(m_style, other.m_style, m_length * sizeof(*m_style));
 	return *this;
 }
 
@@ -409,33 +486,10 @@ RichStringStyle::swap(RichStringStyle &other, bool swapLists)
 		qSwap(m_classList, other.m_classList);
 		qSwap(m_voiceList, other.m_voiceList);
 	}
-	qSwap(m_style, other.m_style);
+	m_spans.swap(other.m_spans);
 	qSwap(m_length, other.m_length);
-	qSwap(m_capacity, other.m_capacity);
-}
-
-void
-RichStringStyle::detach()
-{
-	m_style = nullptr;
-	m_capacity = 0;
 }
 
-void
-RichStringStyle::updateCapacity()
-{
-	if(m_length > m_capacity)
-		m_capacity = m_length * 2;
-	else if(m_length == 0)
-		m_capacity = 0;
-	else if(m_capacity > 100 && m_length < m_capacity / 2)
-		m_capacity = m_capacity / 2;
-	else if(m_style)
-		return;
-
-	delete[] m_style;
-	m_style = m_capacity ? new RichStyle[m_capacity] : nullptr;
-}
 
 
 RichString::RichString(const QString &string, quint8 styleFlags, QRgb styleColor, const QSet<QString> &classList, const QString &voice)
@@ -493,7 +547,7 @@ RichString::setStyleFlagsAt(int index, StyleFlags styleFlags) const
 {
 	if(index < 0 || index >= length())
 		return;
-	(*m_style)[index]->flags() = styleFlags;
+	m_style->modify(index, 1, [styleFlags](RichStyle &style){ style.flags() = styleFlags; });
 }
 
 QRgb
@@ -507,12 +561,13 @@ RichString::setStyleColorAt(int index, QRgb rgbColor) const
 {
 	if(index < 0 || index >= length())
 		return;
-	RichStyle *it = (*m_style)[index];
-	if(rgbColor == 0)
-		it->flags() &= ~RichString::Color;
-	else
-		it->flags() |= RichString::Color;
-	it->color() = rgbColor;
+	m_style->modify(index, 1, [rgbColor](RichStyle &style){
+		if(rgbColor == 0)
+			style.flags() &= ~RichString::Color;
+		else
+			style.flags() |= RichString::Color;
+		style.color() = rgbColor;
+	});
 }
 
 QSet<QString>
@@ -530,13 +585,15 @@ RichString::styleClassesAt(int index) const
 void
 RichString::setStyleClassesAt(int index, const QSet<QString> &classes) const
 {
+	if(index < 0 || index >= length())
+		return;
 	quint64 k = 0;
 	for(const QString &cl: classes) {
 		qint32 i = m_style->classIndex(cl);
 		if(i >= 0)
 			k |= 1ULL << i;
 	}
-	(*m_style)[index]->klass() = k;
+	m_style->modify(index, 1, [k](RichStyle &style){ style.klass() = k; });
 }
 
 QString
@@ -549,15 +606,31 @@ RichString::styleVoiceAt(int index) const
 void
 RichString::setStyleVoiceAt(int index, const QString &voice) const
 {
+	if(index < 0 || index >= length())
+		return;
 	const qint32 v = m_style->voiceIndex(voice);
-	(*m_style)[index]->voice() = v;
+	m_style->modify(index, 1, [v](RichStyle &style){ style.voice() = v; });
+}
+
+int
+RichString::styleSpanEnd(int index) const
+{
+	if(index < 0 || index >= length())
+		return length();
+	return qMin(m_style->spanEnd(m_style->spanAt(index)), length());
 }
 
 QDataStream &
 operator<<(QDataStream &stream, const RichString &string)
 {
 	stream << static_cast<const QString &>(string);
-	stream.writeRawData(reinterpret_cast<const char *>(string.m_style->m_style), string.length() * sizeof(*string.m_style->m_style));
+	// styles are written for every character
+	const RichStringStyle *style = string.m_style;
+	for(int i = 0, n = style->spanCount(); i < n; i++) {
+		const RichStyle &s = style->span(i).style;
+		for(int j = style->span(i).start, e = qMin(style->spanEnd(i), string.length()); j < e; j++)
+			stream.writeRawData(reinterpret_cast<const char *>(&s), sizeof(s));
+	}
 	stream << string.m_style->m_classList;
 	stream << string.m_style->m_voiceList;
 	return stream;
@@ -567,9 +640,14 @@ QDataStream &
 operator>>(QDataStream &stream, RichString &string)
 {
 	stream >> static_cast<QString &>(string);
-	string.m_style->m_length = string.length();
-	string.m_style->updateCapacity();
-	stream.readRawData(reinterpret_cast<char *>(string.m_style->m_style), string.length() * sizeof(*string.m_style->m_style));
+	RichStringStyle *style = string.m_style;
+	style->m_spans.clear();
+	style->m_length = 0;
+	for(int i = 0, n = string.length(); i < n; i++) {
+		RichStyle s;
+		stream.readRawData(reinterpret_cast<char *>(&s), sizeof(s));
+		style->append(1, s);
+	}
 	stream >> string.m_style->m_classList;
 	stream >> string.m_style->m_voiceList;
 	return stream;
@@ -644,10 +722,7 @@ RichString::richString() const
 
 	m_style->richText(ret, -1, prev, true);
 
-	for(int cur = 1; cur < len; cur++) {
-		if(m_style->at(prev) == m_style->at(cur))
-			continue;
-
+	for(int cur = styleSpanEnd(prev); cur < len; cur = styleSpanEnd(cur)) {
 		// place closing html tags before spaces/newlines
 		int cps = cur;
 		while(cur > 0) {
@@ -867,8 +942,8 @@ RichString::StyleFlags
 RichString::cummulativeStyleFlags() const
 {
 	quint8 cummulativeStyleFlags = 0;
-	for(int i = 0, size = length(); i < size; i++) {
-		cummulativeStyleFlags |= m_style->at(i).flags();
+	for(int i = 0, n = m_style->spanCount(); i < n && m_style->span(i).start < length(); i++) {
+		cummulativeStyleFlags |= m_style->span(i).style.flags();
 		if(cummulativeStyleFlags == AllStyles)
 			break;
 	}
@@ -879,8 +954,8 @@ bool
 RichString::hasStyleFlags(StyleFlags styleFlags) const
 {
 	StyleFlags cummulativeStyleFlags = 0;
-	for(int i = 0, size = length(); i < size; i++) {
-		cummulativeStyleFlags |= m_style->at(i).flags();
+	for(int i = 0, n = m_style->spanCount(); i < n && m_style->span(i).start < length(); i++) {
+		cummulativeStyleFlags |= m_style->span(i).style.flags();
 		if((cummulativeStyleFlags & styleFlags) == styleFlags)
 			return true;
 	}
@@ -893,8 +968,7 @@ RichString::setStyleFlags(int index, int len, StyleFlags styleFlags)
 	if(index < 0 || index >= length())
 		return *this;
 
-	for(int end = index + length(index, len); index < end; index++)
-		(*m_style)[index]->flags() = styleFlags;
+	m_style->modify(index, length(index, len), [styleFlags](RichStyle &style){ style.flags() = styleFlags; });
 
 	return *this;
 }
@@ -905,15 +979,11 @@ RichString::setStyleFlags(int index, int len, StyleFlags styleFlags, bool on)
 	if(index < 0 || index >= length())
 		return *this;
 
-	const int end = index + length(index, len);
-	if(on) {
-		for(; index < end; index++)
-			(*m_style)[index]->flags() |= styleFlags;
-	} else {
-		styleFlags = ~styleFlags;
-		for(; index < end; index++)
-			(*m_style)[index]->flags() &= styleFlags;
-	}
+	len = length(index, len);
+	if(on)
+		m_style->modify(index, len, [styleFlags](RichStyle &style){ style.flags() |= styleFlags; });
+	else
+		m_style->modify(index, len, [styleFlags](RichStyle &style){ style.flags() &= ~styleFlags; });
 
 	return *this;
 }
@@ -922,8 +992,8 @@ QSet<QRgb>
 RichString::cummulativeColors() const
 {
 	QSet<QRgb> res;
-	for(int i = 0, n = length(); i < n; i++)
-		res.insert(m_style->at(i).color());
+	for(int i = 0, n = m_style->spanCount(); i < n && m_style->span(i).start < length(); i++)
+		res.insert(m_style->span(i).style.color());
 	return res;
 }
 
@@ -952,13 +1022,13 @@ RichString::setStyleColor(int index, int len, QRgb color)
 	if(index < 0 || index >= length())
 		return *this;
 
-	for(int end = index + length(index, len); index < end; index++) {
-		(*m_style)[index]->color() = color;
+	m_style->modify(index, length(index, len), [color](RichStyle &style){
+		style.color() = color;
 		if(color)
-			(*m_style)[index]->flags() |= Color;
+			style.flags() |= Color;
 		else
-			(*m_style)[index]->flags() &= ~Color;
-	}
+			style.flags() &= ~Color;
+	});
 
 	return *this;
 }
@@ -1418,6 +1488,8 @@ RichString::simplifyWhiteSpace()
 	if(lastWasLineFeed)
 		di--;
 	truncate(di);
+	if(di < m_style->length())
+		m_style->replace(di, m_style->length() - di, 0);
 }
 
 bool
@@ -1426,7 +1498,7 @@ RichString::operator!=(const RichString &richstring) const
 	if(!(static_cast<const QString &>(*this) == static_cast<const QString &>(richstring)))
 		return true;
 
-	for(int i = 0, sz = length(); i < sz; i++) {
+	for(int i = 0, sz = length(); i < sz; i = qMin(styleSpanEnd(i), richstring.styleSpanEnd(i))) {
 		const RichStyle &s1 = m_style->at(i);
 		const RichStyle &s2 = richstring.m_style->at(i);
 		if(s1.flags() != s2.flags())
@@ -1438,6 +1510,62 @@ RichString::operator!=(const RichString &richstring) const
 	return false;
 }
 
+/**
+ * @brief Compares complete style of characters from two strings
+ *
+ * Class and voice indexes are local to each string, so their names are compared.
+ */
+static bool
+equalStyleAt(const RichStringStyle &s1, int i1, const RichStringStyle &s2, int i2)
+{
+	const RichStyle &a = s1.at(i1);
+	const RichStyle &b = s2.at(i2);
+	if(a.flags() != b.flags() || a.color() != b.color())
+		return false;
+	if((a.voice() >= 0) != (b.voice() >= 0) || (a.voice() >= 0 && s1.voiceName(a.voice()) != s2.voiceName(b.voice())))
+		return false;
+	if(!a.klass() || !b.klass())
+		return a.klass() == b.klass();
+	auto classNames = [](const RichStringStyle &s, quint64 k){
+		QSet<QString> res;
+		for(int i = 0; k; k >>= 1, i++) {
+			if(k & 1)
+				res.insert(s.className(i));
+		}
+		return res;
+	};
+	return classNames(s1, a.klass()) == classNames(s2, b.klass());
+}
+
+int
+RichString::commonPrefixLength(const RichString &other) const
+{
+	const int n = qMin(length(), other.length());
+	int i = 0;
+	while(i < n && at(i) == other.at(i) && equalStyleAt(*m_style, i, *other.m_style, i))
+		i++;
+	return i;
+}
+
+int
+RichString::commonSuffixLength(const RichString &other) const
+{
+	const int n = qMin(length(), other.length());
+	int i = 0;
+	for(int i1 = length() - 1, i2 = other.length() - 1; i < n; i++, i1--, i2--) {
+		if(at(i1) != other.at(i2) || !equalStyleAt(*m_style, i1, *other.m_style, i2))
+			break;
+	}
+	return i;
+}
+
+size_t
+RichString::memoryUsage() const
+{
+	return sizeof(RichString) + capacity() * sizeof(QChar)
+		+ sizeof(RichStringStyle) + m_style->spanCount() * sizeof(RichStringStyle::Span);
+}
+
 RichStringList::RichStringList()
 {}
 
@@ -109,6 +109,12 @@ public:
 	QSet<QString> cummulativeVoices() const;
 	void setStyleVoiceAt(int index, const QString &voice) const;
 
+	/**
+	 * @brief Styles are stored for spans of characters, this allows iterating through them
+	 * @return index after the last character that has the same style as character at @p index
+	 */
+	int styleSpanEnd(int index) const;
+
 	void clear();
 
 	RichString & insert(int index, QChar ch);
@@ -169,6 +175,20 @@ public:
 	inline bool operator==(const RichString &richstring) const { return !operator!=(richstring); }
 	bool operator!=(const RichString &richstring) const;
 
+	/**
+	 * @brief Number of leading characters that have same text and style in both strings
+	 */
+	int commonPrefixLength(const RichString &other) const;
+	/**
+	 * @brief Number of trailing characters that have same text and style in both strings
+	 */
+	int commonSuffixLength(const RichString &other) const;
+
+	/**
+	 * @brief Approximate heap memory used by text and styles
+	 */
+	size_t memoryUsage() const;
+
 	inline int length() const { return QString::length(); }
 
 private:
@@ -24,6 +24,7 @@ typedef bool (*charCompare)(QChar ch);
 RichCSS::RichCSS(QObject *parent)
 	: QObject(parent)
 {
+	connect(this, &RichCSS::changed, this, [this](){ m_formatCache.clear(); });
 }
 
 RichCSS::RichCSS(RichCSS &other)
@@ -31,6 +32,7 @@ RichCSS::RichCSS(RichCSS &other)
 	  m_unformatted(other.m_unformatted),
 	  m_stylesheet(other.m_stylesheet)
 {
+	connect(this, &RichCSS::changed, this, [this](){ m_formatCache.clear(); });
 }
 
 RichCSS &
@@ -38,6 +40,7 @@ RichCSS::operator=(const RichCSS &rhs)
 {
 	m_unformatted = rhs.m_unformatted;
 	m_stylesheet = rhs.m_stylesheet;
+	m_formatCache.clear();
 	return *this;
 }
 
@@ -425,6 +428,15 @@ RichCSS::match(QSet<QString> selectors) const
 	return styles;
 }
 
+quint32
+RichCSS::nameId(const QString &name) const
+{
+	auto it = m_nameIds.constFind(name);
+	if(it != m_nameIds.cend())
+		return it.value();
+	return *m_nameIds.insert(name, m_nameIds.size());
+}
+
 QSet<QString>
 RichCSS::classes() const
 {
@@ -8,11 +8,13 @@
 #define RICHCSS_H
 
 #include <QByteArray>
+#include <QHash>
 #include <QMap>
 #include <QObject>
 #include <QSet>
 #include <QString>
 #include <QStringList>
+#include <QTextCharFormat>
 #include <QVector>
 
 #include <list>
@@ -54,6 +56,26 @@ public:
 	 */
 	QSet<QString> classes() const;
 
+	/**
+	 * @brief Format flags followed by interned voice and class ids
+	 */
+	typedef QVector<quint32> SelectorKey;
+
+	/**
+	 * @return small id of class or voice name, same name always gets the same id
+	 */
+	quint32 nameId(const QString &name) const;
+
+	/**
+	 * @brief Format resolved from stylesheet for @p key, cached until stylesheet changes
+	 * @return nullptr if format wasn't cached yet
+	 */
+	inline const QTextCharFormat * cachedFormat(const SelectorKey &key) const {
+		auto it = m_formatCache.constFind(key);
+		return it == m_formatCache.cend() ? nullptr : &it.value();
+	}
+	inline void cacheFormat(const SelectorKey &key, const QTextCharFormat &format) const { m_formatCache.insert(key, format); }
+
 signals:
 	void changed();
 
@@ -68,6 +90,9 @@ private:
 private:
 	QString m_unformatted;
 	Stylesheet m_stylesheet;
+
+	mutable QHash<QString, quint32> m_nameIds;
+	mutable QHash<SelectorKey, QTextCharFormat> m_formatCache;
 };
 }
 
@@ -11,6 +11,7 @@
 #include "helpers/common.h"
 
 #include <QApplication>
+#include <QAtomicInteger>
 #include <QPainter>
 #include <QSharedPointer>
 #include <QSet>
@@ -35,6 +36,9 @@
 
 using namespace SubtitleComposer;
 
+// revisions are unique among all documents, so a new document never takes a revision of a deleted one
+static QAtomicInteger<quint64> lastContentsRevision(0);
+
 struct REStringCapture { int pos; int len; int no; };
 Q_DECLARE_TYPEINFO(REStringCapture, Q_PRIMITIVE_TYPE);
 
@@ -67,7 +71,8 @@ RichDocument::RichDocument(QObject *parent)
 	  m_undoableCursor(this),
 	  m_stylesheet(nullptr),
 	  m_domDirty(true),
-	  m_dom(new RichDOM)
+	  m_dom(new RichDOM),
+	  m_contentsRevision(++lastContentsRevision)
 {
 	setUndoRedoEnabled(true);
 
@@ -82,6 +87,7 @@ RichDocument::RichDocument(QObject *parent)
 
 	connect(this, &RichDocument::contentsChanged, this, [&](){
 		m_domDirty = true;
+		m_contentsRevision = ++lastContentsRevision;
 		emit domChanged();
 	});
 }
@@ -115,6 +121,7 @@ RichDocument::setStylesheet(const RichCSS *css)
 void
 RichDocument::setRichText(const RichString &text, bool resetUndo)
 {
+	const bool undoEnabled = isUndoRedoEnabled();
 	if(resetUndo)
 		setUndoRedoEnabled(false);
 	else
@@ -129,7 +136,7 @@ RichDocument::setRichText(const RichString &text, bool resetUndo)
 	QString currentStyleVoice;
 	QTextCharFormat format;
 	int prev = 0;
-	for(int pos = 0, size = text.length(); pos < size; pos++) {
+	for(int pos = 0, size = text.length(); pos < size; pos = text.styleSpanEnd(pos)) {
 		const int posFlags = text.styleFlagsAt(pos);
 		const QRgb posColor = text.styleColorAt(pos);
 		const QSet<QString> posClasses = text.styleClassesAt(pos);
@@ -171,7 +178,7 @@ RichDocument::setRichText(const RichString &text, bool resetUndo)
 		m_undoableCursor.insertText(text.string().mid(prev), format);
 
 	if(resetUndo)
-		setUndoRedoEnabled(true);
+		setUndoRedoEnabled(undoEnabled);
 	else
 		m_undoableCursor.endEditBlock();
 }
@@ -273,6 +280,7 @@ RichDocument::setHtml(const QString &html, bool resetUndo)
 void
 RichDocument::setPlainText(const QString &text, bool resetUndo)
 {
+	const bool undoEnabled = isUndoRedoEnabled();
 	if(resetUndo)
 		setUndoRedoEnabled(false);
 	else
@@ -281,7 +289,7 @@ RichDocument::setPlainText(const QString &text, bool resetUndo)
 	m_undoableCursor.insertText(text);
 	linesToBlocks();
 	if(resetUndo)
-		setUndoRedoEnabled(true);
+		setUndoRedoEnabled(undoEnabled);
 	else
 		m_undoableCursor.endEditBlock();
 }
@@ -289,6 +297,7 @@ RichDocument::setPlainText(const QString &text, bool resetUndo)
 void
 RichDocument::setDocument(const QTextDocument *doc, bool resetUndo)
 {
+	const bool undoEnabled = isUndoRedoEnabled();
 	if(resetUndo)
 		setUndoRedoEnabled(false);
 	else
@@ -299,7 +308,7 @@ RichDocument::setDocument(const QTextDocument *doc, bool resetUndo)
 	m_undoableCursor.insertFragment(cur.selection());
 	linesToBlocks();
 	if(resetUndo)
-		setUndoRedoEnabled(true);
+		setUndoRedoEnabled(undoEnabled);
 	else
 		m_undoableCursor.endEditBlock();
 }
@@ -307,6 +316,7 @@ RichDocument::setDocument(const QTextDocument *doc, bool resetUndo)
 void
 RichDocument::clear(bool resetUndo)
 {
+	const bool undoEnabled = isUndoRedoEnabled();
 	if(resetUndo)
 		setUndoRedoEnabled(false);
 	else
@@ -314,7 +324,7 @@ RichDocument::clear(bool resetUndo)
 	m_undoableCursor.select(QTextCursor::Document);
 	m_undoableCursor.removeSelectedText();
 	if(resetUndo)
-		setUndoRedoEnabled(true);
+		setUndoRedoEnabled(undoEnabled);
 	else
 		m_undoableCursor.endEditBlock();
 }
@@ -79,6 +79,11 @@ public:
 	void setStylesheet(const RichCSS *css);
 	inline const RichCSS *stylesheet() const { return m_stylesheet; }
 
+	/**
+	 * @brief Process-wide unique value that changes whenever contents or stylesheet of document change
+	 */
+	inline quint64 contentsRevision() const { return m_contentsRevision; }
+
 	RichDOM *dom();
 	QString crumbAt(RichDOM::Node *n);
 	RichDOM::Node *nodeAt(quint32 pos, RichDOM::Node *root=nullptr);
@@ -103,6 +108,7 @@ private:
 	const RichCSS *m_stylesheet;
 	bool m_domDirty;
 	RichDOM *m_dom;
+	quint64 m_contentsRevision;
 
 	void applyChanges(const void *changeList);
 
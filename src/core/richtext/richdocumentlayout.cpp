@@ -11,6 +11,7 @@
 #include "core/richtext/richcss.h"
 #include "core/richtext/richdocument.h"
 
+#include <algorithm>
 #include <climits>
 
 #include <QBasicTimer>
@@ -38,35 +39,10 @@ RichDocumentLayout::RichDocumentLayout(RichDocument *doc)
 {
 }
 
-QTextCharFormat
-RichDocumentLayout::applyCSS(const QTextCharFormat &format) const
+static QTextCharFormat
+cssCharFormat(const RichCSS *css, const QSet<QString> &selectors)
 {
-	QTextCharFormat fmt(format);
-	const RichCSS *css = m_doc->stylesheet();
-	if(!css)
-		return fmt;
-
-	QSet<QString> selectors;
-	if(format.fontWeight() == QFont::Bold)
-		selectors << $("b");
-	if(format.fontItalic())
-		selectors << $("i");
-	if(format.fontUnderline())
-		selectors << $("u");
-	if(format.fontStrikeOut())
-		selectors << $("s");
-	if(format.hasProperty(RichDocument::Class)) {
-		selectors << $("c");
-		const QSet<QString> cl = format.property(RichDocument::Class).value<QSet<QString>>();
-		for(const QString &c: cl)
-			selectors << QChar('.') % c;
-	}
-	if(format.hasProperty(RichDocument::Voice)) {
-		selectors << $("v");
-		selectors << $("v[voice=") % format.property(RichDocument::Voice).toString() % $("]");
-		selectors << $("v[voice=\"") % format.property(RichDocument::Voice).toString() % $("\"]");
-	}
-
+	QTextCharFormat cssFmt;
 	QMap<QByteArray, QString> styles = css->match(selectors);
 	for(auto it = styles.cbegin(); it != styles.cend(); ++it) {
 		if(it.key() == "font-weight") {
@@ -85,23 +61,94 @@ RichDocumentLayout::applyCSS(const QTextCharFormat &format) const
 			};
 			auto iw = wm.find(it.value());
 			if(iw != wm.cend())
-				fmt.setFontWeight(iw.value());
+				cssFmt.setFontWeight(iw.value());
 		} else if(it.key() == "font-style") {
-			fmt.setFontItalic(it.value() != $("normal"));
+			cssFmt.setFontItalic(it.value() != $("normal"));
 		} else if(it.key() == "text-decoration") {
-			fmt.setFontUnderline(it.value() == $("underline"));
-			fmt.setFontStrikeOut(it.value() == $("line-through"));
+			cssFmt.setFontUnderline(it.value() == $("underline"));
+			cssFmt.setFontStrikeOut(it.value() == $("line-through"));
 		} else if(it.key() == "color") {
 			QColor color;
 			color.setNamedColor(it.value());
-			fmt.setForeground(QBrush(color));
+			cssFmt.setForeground(QBrush(color));
 		} else if(it.key() == "background-color") {
 			QColor color;
 			color.setNamedColor(it.value());
-			fmt.setBackground(QBrush(color));
+			cssFmt.setBackground(QBrush(color));
 		}
 		// TODO: check what else WebVTT requires
 	}
+	return cssFmt;
+}
+
+QTextCharFormat
+RichDocumentLayout::applyCSS(const QTextCharFormat &format) const
+{
+	QTextCharFormat fmt(format);
+	const RichCSS *css = m_doc->stylesheet();
+	if(!css)
+		return fmt;
+
+	// styles depend only on format flags, classes and voice - key them by interned ids
+	enum { Bold = 1, Italic = 2, Underline = 4, StrikeOut = 8, Class = 16, Voice = 32 };
+	quint32 flags = 0;
+	if(format.fontWeight() == QFont::Bold)
+		flags |= Bold;
+	if(format.fontItalic())
+		flags |= Italic;
+	if(format.fontUnderline())
+		flags |= Underline;
+	if(format.fontStrikeOut())
+		flags |= StrikeOut;
+	const bool hasClass = format.hasProperty(RichDocument::Class);
+	const QSet<QString> cl = hasClass ? format.property(RichDocument::Class).value<QSet<QString>>() : QSet<QString>();
+	if(hasClass)
+		flags |= Class;
+	const bool hasVoice = format.hasProperty(RichDocument::Voice);
+	const QString voice = hasVoice ? format.property(RichDocument::Voice).toString() : QString();
+	if(hasVoice)
+		flags |= Voice;
+
+	RichCSS::SelectorKey key;
+	key.reserve(2 + cl.size());
+	key.push_back(flags);
+	if(hasVoice)
+		key.push_back(css->nameId(voice));
+	if(hasClass) {
+		const int n = key.size();
+		for(const QString &c: cl)
+			key.push_back(css->nameId(c));
+		std::sort(key.begin() + n, key.end());
+	}
+
+	if(const QTextCharFormat *cssFmt = css->cachedFormat(key)) {
+		fmt.merge(*cssFmt);
+		return fmt;
+	}
+
+	QSet<QString> selectors;
+	if(flags & Bold)
+		selectors << $("b");
+	if(flags & Italic)
+		selectors << $("i");
+	if(flags & Underline)
+		selectors << $("u");
+	if(flags & StrikeOut)
+		selectors << $("s");
+	if(hasClass) {
+		selectors << $("c");
+		for(const QString &c: cl)
+			selectors << QChar('.') % c;
+	}
+	if(hasVoice) {
+		selectors << $("v");
+		selectors << $("v[voice=") % voice % $("]");
+		selectors << $("v[voice=\"") % voice % $("\"]");
+	}
+
+	const QTextCharFormat cssFmt = cssCharFormat(css, selectors);
+	css->cacheFormat(key, cssFmt);
+	fmt.merge(cssFmt);
 	return fmt;
 }
 
@@ -21,6 +21,10 @@
 #include <QTextDocumentFragment>
 #include <QTextEdit>
 
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
 #include <KLocalizedString>
 
 using namespace SubtitleComposer;
@@ -45,9 +49,37 @@ Subtitle::Subtitle(double framesPerSecond)
 	  m_secondaryDirtyState(false),
 	  m_secondaryCleanIndex(0),
 	  m_framesPerSecond(framesPerSecond),
+	  m_times(this),
+	  m_timeIndex(this),
 	  m_stylesheet(new RichCSS(this)),
 	  m_formatData(nullptr)
-{}
+{
+	// times mirror is updated first, time index and other listeners can use it
+	connect(this, &Subtitle::linesInserted, this, [this](int firstIndex, int lastIndex){
+		m_times.insertLines(firstIndex, lastIndex);
+		m_timeIndex.invalidate();
+	});
+	connect(this, &Subtitle::linesRemoved, this, [this](int firstIndex, int lastIndex){
+		m_times.removeLines(firstIndex, lastIndex);
+		m_timeIndex.invalidate();
+	});
+	connect(this, &Subtitle::linesReordered, this, [this](int firstIndex, int lastIndex){
+		m_times.updateLines(firstIndex, lastIndex);
+		m_timeIndex.invalidate();
+	});
+	connect(this, &Subtitle::linesTimesChanged, this, [this](int firstIndex, int lastIndex){
+		m_times.updateLines(firstIndex, lastIndex);
+		m_timeIndex.invalidate();
+	});
+	connect(this, &Subtitle::lineShowTimeChanged, this, [this](SubtitleLine *line){
+		m_times.updateShowTime(line);
+		m_timeIndex.updateShowTime(line);
+	});
+	connect(this, &Subtitle::lineHideTimeChanged, this, [this](SubtitleLine *line){
+		m_times.updateHideTime(line);
+		m_timeIndex.updateHideTime(line);
+	});
+}
 
 Subtitle::~Subtitle()
 {
@@ -56,7 +88,7 @@ Subtitle::~Subtitle()
 }
 
 void
-Subtitle::setPrimaryData(const Subtitle &from, bool usePrimaryData)
+Subtitle::setPrimaryData(Subtitle &from, bool usePrimaryData)
 {
 	beginCompositeAction(i18n("Set Primary Data"));
 
@@ -79,7 +111,7 @@ Subtitle::setPrimaryData(const Subtitle &from, bool usePrimaryData)
 	const int thisErrors = SubtitleLine::SecondaryOnlyErrors;
 
 	for(SubtitleLine *fromLine = fromIt.current(), *thisLine = thisIt.current(); fromLine && thisLine; ++fromIt, ++thisIt, fromLine = fromIt.current(), thisLine = thisIt.current()) {
-		thisLine->setPrimaryDoc(usePrimaryData ? fromLine->primaryDoc() : fromLine->secondaryDoc());
+		thisLine->moveText(true, fromLine, usePrimaryData);
 		thisLine->setTimes(fromLine->showTime(), fromLine->hideTime());
 		thisLine->setErrorFlags((fromLine->errorFlags() & fromErrors) | (thisLine->errorFlags() & thisErrors));
 		thisLine->setFormatData(fromLine->formatData());
@@ -90,9 +122,9 @@ Subtitle::setPrimaryData(const Subtitle &from, bool usePrimaryData)
 	if(fromIt.current()) { // from has more lines
 		QList<SubtitleLine *> lines;
 		for(; fromIt.current(); ++fromIt) {
-			const SubtitleLine *cur = fromIt.current();
+			SubtitleLine *cur = fromIt.current();
 			SubtitleLine *thisLine = new SubtitleLine(cur->showTime(), cur->hideTime());
-			thisLine->setPrimaryDoc(usePrimaryData ? cur->primaryDoc() : cur->secondaryDoc());
+			thisLine->moveText(true, cur, usePrimaryData);
 			thisLine->setErrorFlags(SubtitleLine::SecondaryOnlyErrors, false);
 			thisLine->setFormatData(cur->formatData());
 			thisLine->m_metaData = cur->m_metaData;
@@ -127,7 +159,7 @@ Subtitle::clearPrimaryTextData()
 }
 
 void
-Subtitle::setSecondaryData(const Subtitle &from, bool usePrimaryData)
+Subtitle::setSecondaryData(Subtitle &from, bool usePrimaryData)
 {
 	beginCompositeAction(i18n("Set Secondary Data"));
 
@@ -135,9 +167,9 @@ Subtitle::setSecondaryData(const Subtitle &from, bool usePrimaryData)
 	const int dstErrors = SubtitleLine::PrimaryOnlyErrors | SubtitleLine::SharedErrors;
 
 	for(int i = 0, n = qMin(m_lines.size(), from.m_lines.size()); i < n; i++) {
-		const SubtitleLine *srcLine = from.m_lines.at(i).obj();
+		SubtitleLine *srcLine = from.m_lines.at(i).obj();
 		SubtitleLine *dstLine = m_lines.at(i).obj();
-		dstLine->setSecondaryDoc(usePrimaryData ? srcLine->primaryDoc() : srcLine->secondaryDoc());
+		dstLine->moveText(false, srcLine, usePrimaryData);
 		dstLine->setErrorFlags((dstLine->errorFlags() & dstErrors) | (srcLine->errorFlags() & srcErrors));
 	}
 
@@ -151,9 +183,9 @@ Subtitle::setSecondaryData(const Subtitle &from, bool usePrimaryData)
 	// insert remaining source translations
 	QList<SubtitleLine *> newLines;
 	for(int i = m_lines.size(), n = from.m_lines.size(); i < n; i++) {
-		const SubtitleLine *srcLine = from.m_lines.at(i).obj();
+		SubtitleLine *srcLine = from.m_lines.at(i).obj();
 		SubtitleLine *dstLine = new SubtitleLine(srcLine->showTime(), srcLine->hideTime());
-		dstLine->setSecondaryDoc(usePrimaryData ? srcLine->primaryDoc() : srcLine->secondaryDoc());
+		dstLine->moveText(false, srcLine, usePrimaryData);
 		dstLine->setErrorFlags(SubtitleLine::PrimaryOnlyErrors, false);
 		newLines.append(dstLine);
 	}
@@ -240,7 +272,7 @@ Subtitle::changeFramesPerSecond(double toFramesPerSecond, double fromFramesPerSe
 
 	double scaleFactor = fromFramesPerSecond / toFramesPerSecond;
 
-	if(scaleFactor != 1.0) {
+	if(scaleFactor != 1.0 && !transformTimes(RangeList(Range::full()), 0., scaleFactor)) {
 		for(SubtitleIterator it(*this, Range::full()); it.current(); ++it) {
 			Time showTime = it.current()->showTime();
 			showTime *= scaleFactor;
@@ -266,6 +298,21 @@ Subtitle::line(int index) const
 {
 	return index < 0 || size_t(index) >= m_lines.size() ? nullptr : m_lines.at(index).obj();
 }
+
+/**
+ * @brief Estimated memory saved by lines that keep their text without documents
+ *
+ * Walks all lines, so it is meant for diagnostics rather than being called on every change.
+ */
+qint64
+Subtitle::compactMemorySaved() const
+{
+	qint64 saved = 0;
+	for(const auto &ref: m_lines)
+		saved += ref.obj()->compactMemorySaved();
+	return saved;
+}
+
 bool
 Subtitle::hasAnchors() const
 {
@@ -332,16 +379,9 @@ Subtitle::removeAllAnchors()
 int
 Subtitle::insertIndex(const Time &showTime, int start, int end) const
 {
-	while(end - start > 1) {
-		const int mid = (start + end) / 2;
-		if(showTime < m_lines.at(mid)->showTime())
-			end = mid - 1;
-		else
-			start = mid;
-	}
-	if(m_lines.empty() || showTime < m_lines.at(start)->showTime())
+	if(m_lines.empty())
 		return start;
-	return showTime < m_lines.at(end)->showTime() ? end : end + 1;
+	return m_times.upperBound(showTime.toMillis(), start, end + 1);
 }
 
 void
@@ -361,6 +401,26 @@ Subtitle::insertLine(SubtitleLine *line, int index)
 	processAction(new InsertLinesAction(this, lines, index));
 }
 
+void
+Subtitle::insertLines(const QList<SubtitleLine *> &lines)
+{
+	// lines are expected to be sorted by show time
+	if(lines.isEmpty())
+		return;
+
+	const int index = insertIndex(lines.first()->showTime());
+	if(size_t(index) == m_lines.size() || lines.last()->showTime() < m_lines.at(index)->showTime()) {
+		// new lines fit in between existing ones - insert them as a single block
+		processAction(new InsertLinesAction(this, lines, index));
+		return;
+	}
+
+	beginCompositeAction(i18n("Insert Lines"));
+	for(SubtitleLine *line: lines)
+		insertLine(line);
+	endCompositeAction();
+}
+
 SubtitleLine *
 Subtitle::insertNewLine(int index, bool insertAfter, SubtitleTarget target)
 {
@@ -406,7 +466,7 @@ Subtitle::insertNewLine(int index, bool insertAfter, SubtitleTarget target)
 		SubtitleLine *line = newLine;
 		SubtitleIterator it(*this, Range::full(), false);
 		for(it.toIndex(newLineIndex + 1); it.current(); ++it) {
-			line->secondaryDoc()->setRichText(it.current()->secondaryDoc()->toRichText());
+			line->secondaryDoc()->setRichText(it.current()->secondaryText());
 			line = it.current();
 		}
 		line->secondaryDoc()->clear();
@@ -420,7 +480,7 @@ Subtitle::insertNewLine(int index, bool insertAfter, SubtitleTarget target)
 		SubtitleIterator it(*this, Range::full(), true);
 		SubtitleLine *line = it.current();
 		for(--it; it.index() >= index; --it) {
-			line->secondaryDoc()->setRichText(it.current()->secondaryDoc()->toRichText());
+			line->secondaryDoc()->setRichText(it.current()->secondaryText());
 			line = it.current();
 		}
 		line->secondaryDoc()->clear();
@@ -465,7 +525,7 @@ Subtitle::removeLines(const RangeList &r, SubtitleTarget target)
 		SubtitleIterator srcIt(*this, rangesComplement);
 		SubtitleIterator dstIt(*this, Range::upper(ranges.firstIndex()));
 		for(; srcIt.current() && dstIt.current(); ++srcIt, ++dstIt)
-			dstIt.current()->secondaryDoc()->setRichText(srcIt.current()->secondaryDoc()->toRichText());
+			dstIt.current()->secondaryDoc()->setRichText(srcIt.current()->secondaryText());
 
 		// the remaining lines secondary text must be cleared
 		for(; dstIt.current(); ++dstIt)
@@ -504,7 +564,7 @@ Subtitle::removeLines(const RangeList &r, SubtitleTarget target)
 		SubtitleIterator srcIt(*this, Range(ranges.firstIndex(), m_lines.size() - lines.count() - 1), true);
 		SubtitleIterator dstIt(*this, rangesComplement, true);
 		for(; srcIt.current() && dstIt.current(); --srcIt, --dstIt)
-			dstIt.current()->secondaryDoc()->setRichText(srcIt.current()->secondaryDoc()->toRichText());
+			dstIt.current()->secondaryDoc()->setRichText(srcIt.current()->secondaryText());
 
 		// finally, we can remove the specified lines
 		RangeList::ConstIterator rangesIt = ranges.end(), begin = ranges.begin();
@@ -727,6 +787,10 @@ Subtitle::shiftAnchoredLine(SubtitleLine *anchoredLine, const Time &newShowTime)
 		if(newShowTime.toMillis() < lastShowTime && anchoredLine != last) {
 			anchoredLine->m_showTime = savedShowTime;
 			anchoredLine->m_hideTime = savedHideTime;
+			// times were restored without signals
+			m_timeIndex.invalidate();
+			const int idx = anchoredLine->index();
+			m_times.updateLines(idx, idx);
 			adjustLines(Range(anchoredLine->index(), last->index()), newShowTime.toMillis(), lastShowTime);
 		}
 	}
@@ -748,7 +812,7 @@ Subtitle::shiftLines(const RangeList &ranges, long msecs)
 				break;
 			}
 		}
-	} else {
+	} else if(!transformTimes(ranges, msecs, 1.)) {
 		for(SubtitleIterator it(*this, ranges); it.current(); ++it)
 			it.current()->shiftTimes(msecs);
 	}
@@ -796,8 +860,10 @@ Subtitle::adjustLines(const Range &range, long newFirstTime, long newLastTime)
 
 	beginCompositeAction(i18n("Adjust Lines"));
 
-	for(SubtitleIterator it(*this, range); it.current(); ++it)
-		it.current()->adjustTimes(shiftMseconds, scaleFactor);
+	if(!transformTimes(RangeList(range), shiftMseconds, scaleFactor)) {
+		for(SubtitleIterator it(*this, range); it.current(); ++it)
+			it.current()->adjustTimes(shiftMseconds, scaleFactor);
+	}
 
 	endCompositeAction();
 }
@@ -805,29 +871,33 @@ Subtitle::adjustLines(const Range &range, long newFirstTime, long newLastTime)
 void
 Subtitle::sortLines(const Range &range)
 {
-	beginCompositeAction(i18n("Sort"));
-
-	SubtitleIterator it(*this, range);
-	SubtitleLine *line = it.current();
-	SubtitleLine *nextLine = (++it).current();
-	for(; nextLine; ++it, line = nextLine, nextLine = it.current()) {
-		if(line->showTime() <= nextLine->showTime()) // already sorted
-			continue;
-
-		// TODO: could be improved by using insertIndex()
-		SubtitleIterator tmp(it);
-		int fromIndex = tmp.index();
-		int toIndex = -1;
-		while((--tmp).current() && tmp.current()->showTime() > nextLine->showTime())
-			toIndex = tmp.index();
-
-		Q_ASSERT(toIndex != -1);
+	if(m_lines.empty())
+		return;
 
-		processAction(new MoveLineAction(this, fromIndex, toIndex));
+	const int firstIndex = normalizeRangeIndex(range.start());
+	const int lastIndex = normalizeRangeIndex(range.end());
+	if(firstIndex >= lastIndex)
+		return;
 
-		--it;
+	const int n = lastIndex - firstIndex + 1;
+	std::vector<double> showTimes(n);
+	bool sorted = true;
+	for(int i = 0; i < n; i++) {
+		showTimes[i] = at(firstIndex + i)->showTime().toMillis();
+		if(i && showTimes[i] < showTimes[i - 1])
+			sorted = false;
 	}
+	if(sorted)
+		return;
 
+	QVector<int> permutation(n);
+	std::iota(permutation.begin(), permutation.end(), 0);
+	std::stable_sort(permutation.begin(), permutation.end(), [&](int i1, int i2){
+		return showTimes[i1] < showTimes[i2];
+	});
+
+	beginCompositeAction(i18n("Sort"));
+	processAction(new PermuteLinesAction(this, firstIndex, permutation));
 	endCompositeAction();
 }
 
@@ -840,31 +910,16 @@ Subtitle::applyDurationLimits(const RangeList &ranges, const Time &minDuration,
 	beginCompositeAction(i18n("Enforce Duration Limits"));
 
 	for(RangeList::ConstIterator rangesIt = ranges.begin(), end = ranges.end(); rangesIt != end; ++rangesIt) {
-		Time lineDuration;
-		SubtitleIterator it(*this, *rangesIt);
-		SubtitleLine *line = it.current();
-		++it;
-		SubtitleLine *nextLine = it.current();
+		const int firstIndex = rangesIt->start();
+		const int lastIndex = normalizeRangeIndex(rangesIt->end());
+		if(firstIndex > lastIndex)
+			continue;
 
-		for(; line; ++it, line = nextLine, nextLine = it.current()) {
-			lineDuration = line->durationTime();
-
-			if(lineDuration > maxDuration)
-				line->setDurationTime(maxDuration);
-			else if(lineDuration < minDuration) {
-				if(!nextLine) // the last line doesn't have risk of overlapping
-					line->setDurationTime(minDuration);
-				else {
-					if(canOverlap || line->showTime() + minDuration < nextLine->showTime())
-						line->setDurationTime(minDuration);
-					else {          // setting the duration to minDuration will cause an unwanted overlap
-						if(line->hideTime() < nextLine->showTime()) // make duration as big as possible without overlap
-							line->setHideTime(nextLine->showTime() - 1);
-						// else line is already at the maximum duration without overlap (or overlapping) so we don't change it
-					}
-				}
-			}
-		}
+		const int count = lastIndex - firstIndex + 1;
+		std::vector<double> hideTimes(count);
+		SubtitleTimes::limitDurations(m_times.showTimes() + firstIndex, m_times.hideTimes() + firstIndex, count,
+			minDuration.toMillis(), maxDuration.toMillis(), canOverlap, hideTimes.data());
+		applyHideTimes(firstIndex, hideTimes);
 	}
 
 	endCompositeAction();
@@ -879,15 +934,15 @@ Subtitle::setMaximumDurations(const RangeList &ranges)
 	beginCompositeAction(i18n("Maximize Durations"));
 
 	for(RangeList::ConstIterator rangesIt = ranges.begin(), end = ranges.end(); rangesIt != end; ++rangesIt) {
-		SubtitleIterator it(*this, *rangesIt);
-		SubtitleLine *line = it.current();
-		++it;
-		SubtitleLine *nextLine = it.current();
+		const int firstIndex = rangesIt->start();
+		const int lastIndex = normalizeRangeIndex(rangesIt->end());
+		if(firstIndex >= lastIndex)
+			continue;
 
-		for(; line && nextLine; ++it, line = nextLine, nextLine = it.current()) {
-			if(line->hideTime() < nextLine->showTime())
-				line->setHideTime(nextLine->showTime() - 1);
-		}
+		const int count = lastIndex - firstIndex + 1;
+		std::vector<double> hideTimes(count);
+		SubtitleTimes::maximizeDurations(m_times.showTimes() + firstIndex, m_times.hideTimes() + firstIndex, count, hideTimes.data());
+		applyHideTimes(firstIndex, hideTimes);
 	}
 
 	endCompositeAction();
@@ -941,17 +996,10 @@ Subtitle::fixOverlappingLines(const RangeList &ranges, const Time &minInterval)
 		if(rangeStart >= rangeEnd)
 			break;
 
-		SubtitleIterator it(*this, Range(rangeStart, rangeEnd));
-		SubtitleLine *line = it.current();
-		++it;
-		SubtitleLine *nextLine = it.current();
-
-		for(; nextLine; ++it, line = nextLine, nextLine = it.current()) {
-			if(line->hideTime() + minInterval >= nextLine->showTime()) {
-				Time newHideTime = nextLine->showTime() - minInterval;
-				line->setHideTime(newHideTime >= line->showTime() ? newHideTime : line->showTime());
-			}
-		}
+		const int count = rangeEnd - rangeStart + 1;
+		std::vector<double> hideTimes(count);
+		SubtitleTimes::fixOverlaps(m_times.showTimes() + rangeStart, m_times.hideTimes() + rangeStart, count, minInterval.toMillis(), hideTimes.data());
+		applyHideTimes(rangeStart, hideTimes);
 	}
 
 	endCompositeAction();
@@ -1189,8 +1237,8 @@ Subtitle::appendSubtitle(const Subtitle &srcSubtitle, double shiftMsecsBeforeApp
 	for(SubtitleIterator it(srcSubtitle); it.current(); ++it) {
 		SubtitleLine *ln = it.current();
 		SubtitleLine *newLine = new SubtitleLine(ln->showTime() + shiftMsecsBeforeAppend, ln->hideTime() + shiftMsecsBeforeAppend);
-		newLine->primaryDoc()->setDocument(ln->primaryDoc());
-		newLine->secondaryDoc()->setDocument(ln->secondaryDoc());
+		newLine->setPrimaryText(ln->primaryText());
+		newLine->setSecondaryText(ln->secondaryText());
 		lines.append(newLine);
 	}
 
@@ -1226,8 +1274,8 @@ Subtitle::splitSubtitle(Subtitle &dstSubtitle, const Time &splitTime, bool shift
 			}
 
 			SubtitleLine *newLine = new SubtitleLine(newShowTime, ln->hideTime() + shiftTime);
-			newLine->primaryDoc()->setDocument(ln->primaryDoc());
-			newLine->secondaryDoc()->setDocument(ln->secondaryDoc());
+			newLine->setPrimaryText(ln->primaryText());
+			newLine->setSecondaryText(ln->secondaryText());
 			if(ln->m_formatData)
 				newLine->m_formatData = new FormatData(*ln->m_formatData);
 
@@ -1257,6 +1305,40 @@ Subtitle::splitSubtitle(Subtitle &dstSubtitle, const Time &splitTime, bool shift
 	}
 }
 
+/**
+ * @brief Creates a detached copy of the subtitle that keeps texts in compact form
+ *
+ * Copy doesn't share any documents with this subtitle, so it's safe to read it
+ * from other threads (e.g. while exporting).
+ */
+Subtitle *
+Subtitle::snapshot() const
+{
+	Subtitle *copy = new Subtitle(m_framesPerSecond);
+	copy->m_metaData = m_metaData;
+	delete copy->m_stylesheet;
+	copy->m_stylesheet = new RichCSS(*m_stylesheet);
+	copy->m_stylesheet->setParent(copy);
+	copy->m_formatData = m_formatData ? new FormatData(*m_formatData) : nullptr;
+
+	SubtitleLineBatch batch(copy, m_lines.size());
+	for(const auto &ref : m_lines) {
+		const SubtitleLine *line = ref.obj();
+		SubtitleLine *newLine = new SubtitleLine(line->showTime(), line->hideTime());
+		newLine->setPrimaryText(line->primaryText());
+		newLine->setSecondaryText(line->secondaryText());
+		newLine->m_errorFlags = line->m_errorFlags;
+		newLine->m_metaData = line->m_metaData;
+		newLine->m_position = line->m_position;
+		if(line->m_formatData)
+			newLine->m_formatData = new FormatData(*line->m_formatData);
+		batch.append(newLine);
+	}
+	batch.commit();
+
+	return copy;
+}
+
 void
 Subtitle::toggleStyleFlag(const RangeList &ranges, RichString::StyleFlag styleFlag)
 {
@@ -1394,16 +1476,46 @@ Subtitle::processAction(UndoAction *action) const
 	}
 }
 
+/**
+ * @brief Transforms times of all lines in @p ranges with a single undo action
+ * @return false when transformation can't be inverted (@p scaleFactor is not positive) and
+ *  lines need to be changed one by one
+ */
+bool
+Subtitle::transformTimes(const RangeList &ranges, double shiftMseconds, double scaleFactor)
+{
+	if(scaleFactor <= 0.)
+		return false;
+
+	processAction(new TransformTimesAction(this, ranges, shiftMseconds, scaleFactor));
+	return true;
+}
+
+void
+Subtitle::applyHideTimes(int firstIndex, const std::vector<double> &hideTimes)
+{
+	// setting hide times updates mirrored times, they are read again on every iteration
+	for(size_t i = 0; i < hideTimes.size(); i++) {
+		if(m_times.hideTimes()[firstIndex + i] != hideTimes[i])
+			at(firstIndex + i)->setHideTime(hideTimes[i]);
+	}
+}
+
 void
 Subtitle::beginCompositeAction(const QString &title) const
 {
 	if(appSubtitle() == this)
 		appUndoStack()->beginMacro(title);
+	if(m_compositeActionDepth++ == 0)
+		emit const_cast<Subtitle *>(this)->compositeActionStart();
 }
 
 void
 Subtitle::endCompositeAction(UndoStack::DirtyMode dirtyOverride) const
 {
+	// emitted while macro is still open, so changes made by listeners are part of it
+	if(--m_compositeActionDepth == 0)
+		emit const_cast<Subtitle *>(this)->compositeActionEnd();
 	if(appSubtitle() == this)
 		appUndoStack()->endMacro(dirtyOverride);
 }
@@ -1495,3 +1607,44 @@ SubtitleCompositeActionExecutor::~SubtitleCompositeActionExecutor()
 {
 	m_subtitle->endCompositeAction();
 }
+
+/// SUBTITLELINEBATCH
+
+SubtitleLineBatch::SubtitleLineBatch(Subtitle *subtitle, int reserveSize)
+	: m_subtitle(subtitle),
+	  m_sorted(true)
+{
+	if(reserveSize > 0)
+		m_lines.reserve(reserveSize);
+}
+
+SubtitleLineBatch::~SubtitleLineBatch()
+{
+	commit();
+}
+
+void
+SubtitleLineBatch::append(SubtitleLine *line)
+{
+	if(m_sorted && !m_lines.isEmpty() && line->showTime() < m_lines.last()->showTime())
+		m_sorted = false;
+	m_lines.append(line);
+}
+
+void
+SubtitleLineBatch::commit()
+{
+	if(m_lines.isEmpty())
+		return;
+
+	if(!m_sorted) {
+		std::stable_sort(m_lines.begin(), m_lines.end(), [](const SubtitleLine *l1, const SubtitleLine *l2){
+			return l1->showTime() < l2->showTime();
+		});
+	}
+
+	m_subtitle->insertLines(m_lines);
+
+	m_lines.clear();
+	m_sorted = true;
+}
@@ -13,6 +13,8 @@
 #include "core/time.h"
 #include "core/richstring.h"
 #include "core/subtitletarget.h"
+#include "core/subtitletimeindex.h"
+#include "core/subtitletimes.h"
 #include "core/undo/undostack.h"
 #include "helpers/objectref.h"
 #include "formatdata.h"
@@ -51,6 +53,8 @@ class Subtitle : public QObject, public QSharedData
 	friend class InsertLinesAction;
 	friend class RemoveLinesAction;
 	friend class MoveLineAction;
+	friend class PermuteLinesAction;
+	friend class TransformTimesAction;
 	friend class EditStylesheetAction;
 
 	friend class SubtitleLineAction;
@@ -64,6 +68,7 @@ class Subtitle : public QObject, public QSharedData
 	friend class ToggleLineMarkedAction;
 
 	friend class SubtitleCompositeActionExecutor;
+	friend class SubtitleLineBatch;
 
 	friend class Format;
 	friend class InputFormat;
@@ -75,12 +80,13 @@ public:
 	Subtitle(double framesPerSecond = defaultFramesPerSecond());
 	virtual ~Subtitle();
 
-/// primary data includes primary text, timing information, format data and all errors except secondary only errors
-	void setPrimaryData(const Subtitle &from, bool usePrimaryData);
+/// primary data includes primary text, timing information, format data and all errors except secondary only errors,
+/// texts are moved out of @p from lines
+	void setPrimaryData(Subtitle &from, bool usePrimaryData);
 	void clearPrimaryTextData();
 
-/// secondary data includes secondary text and secondary only errors
-	void setSecondaryData(const Subtitle &from, bool usePrimaryData);
+/// secondary data includes secondary text and secondary only errors, texts are moved out of @p from lines
+	void setSecondaryData(Subtitle &from, bool usePrimaryData);
 	void clearSecondaryTextData();
 
 	inline bool isPrimaryDirty() const { return m_primaryDirtyState; }
@@ -112,6 +118,18 @@ public:
 	inline const SubtitleLine * operator[](const int i) const { return m_lines.at(i).obj(); }
 	inline SubtitleLine * operator[](const int i) { return m_lines.at(i).obj(); }
 
+	/**
+	 * @brief Lines that are shown at any moment of time span [start, end], ordered by show time
+	 */
+	inline QVector<SubtitleLine *> linesInTimespan(const Time &start, const Time &end) { return m_timeIndex.overlapping(start.toMillis(), end.toMillis()); }
+
+	/**
+	 * @brief Show and hide times of all lines as contiguous arrays, in lines order
+	 */
+	inline const SubtitleTimes & times() const { return m_times; }
+
+	qint64 compactMemorySaved() const;
+
 	bool hasAnchors() const;
 	bool isLineAnchored(int index) const;
 	bool isLineAnchored(const SubtitleLine *line) const;
@@ -154,6 +172,7 @@ public:
 	void syncWithSubtitle(const Subtitle &refSubtitle);
 	void appendSubtitle(const Subtitle &srcSubtitle, double shiftMsecsBeforeAppend);
 	void splitSubtitle(Subtitle &dstSubtitle, const Time &splitTime, bool shiftSplitLines);
+	Subtitle * snapshot() const;
 
 	void toggleStyleFlag(const RangeList &ranges, RichString::StyleFlag styleFlag);
 	void changeTextColor(const RangeList &ranges, QRgb color);
@@ -187,6 +206,9 @@ signals:
 	void linesInserted(int firstIndex, int lastIndex);
 	void linesAboutToBeRemoved(int firstIndex, int lastIndex);
 	void linesRemoved(int firstIndex, int lastIndex);
+	void linesAboutToBeReordered(int firstIndex, int lastIndex);
+	void linesReordered(int firstIndex, int lastIndex);
+	void linesTimesChanged(int firstIndex, int lastIndex);
 
 	void compositeActionStart();
 	void compositeActionEnd();
@@ -205,6 +227,7 @@ private:
 	inline int insertIndex(const Time &showTime) const { return insertIndex(showTime, 0, m_lines.empty() ? 0 : m_lines.size() - 1); }
 	int insertIndex(const Time &showTime, int start, int end) const;
 	void insertLine(SubtitleLine *line, int index);
+	void insertLines(const QList<SubtitleLine *> &lines);
 
 	FormatData * formatData() const;
 	void setFormatData(const FormatData *formatData);
@@ -213,6 +236,9 @@ private:
 	void endCompositeAction(UndoStack::DirtyMode dirtyOverride = UndoStack::Invalid) const;
 	void processAction(UndoAction *action) const;
 
+	bool transformTimes(const RangeList &ranges, double shiftMseconds, double scaleFactor);
+	void applyHideTimes(int firstIndex, const std::vector<double> &hideTimes);
+
 	bool isPrimaryDirty(int index) const;
 	bool isSecondaryDirty(int index) const;
 	void updateState();
@@ -234,9 +260,12 @@ private:
 	int m_secondaryCleanIndex;
 
 	bool m_ignoreDocChanges = false;
+	mutable int m_compositeActionDepth = 0;
 
 	double m_framesPerSecond;
 	mutable ObjectRefArray<SubtitleLine> m_lines;
+	SubtitleTimes m_times;
+	SubtitleTimeIndex m_timeIndex;
 	QList<QPointer<const SubtitleLine>> m_anchoredLines;
 
 	QMap<QByteArray, QString> m_metaData;
@@ -257,6 +286,30 @@ public:
 private:
 	const Subtitle *m_subtitle;
 };
+
+/**
+ * @brief Collects lines and inserts them into subtitle with a single InsertLinesAction
+ *
+ * Meant for format parsers and other bulk producers of lines. Lines don't have to be appended
+ * in show time order, but appending them sorted avoids the final sort. Pending lines are
+ * committed on destruction.
+ */
+class SubtitleLineBatch
+{
+public:
+	SubtitleLineBatch(Subtitle *subtitle, int reserveSize = 0);
+	~SubtitleLineBatch();
+
+	void append(SubtitleLine *line);
+	void commit();
+
+	inline int count() const { return m_lines.size(); }
+
+private:
+	Subtitle *m_subtitle;
+	QList<SubtitleLine *> m_lines;
+	bool m_sorted;
+};
 }
 
 #include "subtitleline.h"
@@ -12,14 +12,60 @@
 #include "helpers/common.h"
 #include "scconfig.h"
 
+#include <QAtomicInteger>
 #include <QRegularExpression>
 
 #include <KLocalizedString>
 
+#include <algorithm>
+#include <array>
 #include <math.h>
 
+#if defined(__GLIBC__)
+#include <malloc.h>
+#if __GLIBC_PREREQ(2, 33)
+#define HAVE_MALLINFO2
+#endif
+#endif
+
 using namespace SubtitleComposer;
 
+static QAtomicInteger<quint64> lastTextRevision(0);
+
+static bool
+hasUnneededSpaces(const QString &plainText)
+{
+	static const QRegularExpression unneededSpaceRegExp("(^\\s|\\s$|¿\\s|¡\\s|\\s\\s|\\s!|\\s\\?|\\s:|\\s;|\\s,|\\s\\.)");
+
+	// match each line separately, same as QTextDocument::find()
+	const QStringList lines = plainText.split(u'\n');
+	for(const QString &line: lines) {
+		if(line.contains(unneededSpaceRegExp))
+			return true;
+	}
+	return false;
+}
+
+static bool
+hasCapitalAfterEllipsis(const QString &plainText)
+{
+	staticRE$(capitalAfterEllipsisRegExp, "^\\s*\\.\\.\\.[¡¿\\.,;\\(\\[\\{\"'\\s]*", REu);
+
+	QRegularExpressionMatchIterator it = capitalAfterEllipsisRegExp.globalMatch(plainText);
+	if(!it.hasNext())
+		return false;
+	const QChar chr = plainText.at(it.next().capturedEnd());
+	return chr.isLetter() && chr == chr.toUpper();
+}
+
+static bool
+hasUnneededDash(const QString &plainText)
+{
+	staticRE$(unneededDashRegExp, "(^|\n)\\s*-[^-]", REu);
+
+	return plainText.count(unneededDashRegExp) == 1;
+}
+
 
 SubtitleLine::ErrorFlag
 SubtitleLine::errorFlag(SubtitleLine::ErrorID id)
@@ -127,9 +173,6 @@ SubtitleLine::fullErrorText(SubtitleLine::ErrorID errorID) const
 void
 SubtitleLine::setupSignals()
 {
-	connect(m_primaryDoc, &RichDocument::contentsChanged, this, &SubtitleLine::primaryDocumentChanged);
-	connect(m_secondaryDoc, &RichDocument::contentsChanged, this, &SubtitleLine::secondaryDocumentChanged);
-
 	QObject::connect(this, &SubtitleLine::primaryTextChanged, [this](){
 		if(subtitle()) emit subtitle()->linePrimaryTextChanged(this);
 	});
@@ -147,8 +190,8 @@ SubtitleLine::setupSignals()
 SubtitleLine::SubtitleLine()
 	: QObject(),
 	  m_subtitle(nullptr),
-	  m_primaryDoc(new RichDocument(this)),
-	  m_secondaryDoc(new RichDocument(this)),
+	  m_primaryDoc(nullptr),
+	  m_secondaryDoc(nullptr),
 	  m_showTime(0.0),
 	  m_hideTime(0.0),
 	  m_errorFlags(0),
@@ -160,8 +203,8 @@ SubtitleLine::SubtitleLine()
 SubtitleLine::SubtitleLine(const Time &showTime, const Time &hideTime)
 	: QObject(),
 	  m_subtitle(nullptr),
-	  m_primaryDoc(new RichDocument(this)),
-	  m_secondaryDoc(new RichDocument(this)),
+	  m_primaryDoc(nullptr),
+	  m_secondaryDoc(nullptr),
 	  m_showTime(showTime),
 	  m_hideTime(hideTime),
 	  m_errorFlags(0),
@@ -198,6 +241,8 @@ SubtitleLine::SubtitleLine(const Time &showTime, const Time &hideTime)
 
 SubtitleLine::~SubtitleLine()
 {
+	delete m_primaryText;
+	delete m_secondaryText;
 	delete m_formatData;
 }
 
@@ -248,20 +293,299 @@ SubtitleLine::index() const
 	return index;
 }
 
+/**
+ * @brief Records document change as undoable action against the last known text
+ */
 void
-SubtitleLine::primaryDocumentChanged()
+SubtitleLine::documentChanged(bool primary)
 {
-	if(m_ignoreDocChanges || (m_subtitle && m_subtitle->m_ignoreDocChanges))
+	(primary ? m_primaryMetrics : m_secondaryMetrics).valid = false;
+
+	const RichString *text = primary ? m_primaryText : m_secondaryText;
+	const RichString before = text ? *text : RichString();
+	const RichString after = (primary ? m_primaryDoc : m_secondaryDoc)->toRichText();
+	const int same = before.commonPrefixLength(after);
+	const bool changed = same != before.length() || same != after.length();
+	storeText(primary, after, changed);
+
+	if(m_ignoreDocChanges || (m_subtitle && m_subtitle->m_ignoreDocChanges) || !changed)
 		return;
-	processAction(new SetLinePrimaryTextAction(this, m_primaryDoc));
+	if(primary)
+		processAction(new SetLinePrimaryTextAction(this, before, after));
+	else
+		processAction(new SetLineSecondaryTextAction(this, before, after));
+}
+
+void
+SubtitleLine::primaryDocumentChanged()
+{
+	documentChanged(true);
 }
 
 void
 SubtitleLine::secondaryDocumentChanged()
 {
-	if(m_ignoreDocChanges || (m_subtitle && m_subtitle->m_ignoreDocChanges))
+	documentChanged(false);
+}
+
+RichDocument *
+SubtitleLine::createDoc(bool primary) const
+{
+	SubtitleLine *self = const_cast<SubtitleLine *>(this);
+	RichString *&text = primary ? m_primaryText : m_secondaryText;
+
+	RichDocument *doc = new RichDocument(self);
+	// changes are undone by line text actions, document doesn't need own history
+	doc->setUndoRedoEnabled(false);
+	doc->setStylesheet(m_subtitle ? m_subtitle->m_stylesheet : nullptr);
+	if(text) {
+		doc->setRichText(*text, true);
+		storeText(primary, doc->toRichText(), false);
+	}
+
+	if(primary) {
+		m_primaryDoc = doc;
+		connect(doc, &RichDocument::contentsChanged, self, &SubtitleLine::primaryDocumentChanged);
+	} else {
+		m_secondaryDoc = doc;
+		connect(doc, &RichDocument::contentsChanged, self, &SubtitleLine::secondaryDocumentChanged);
+	}
+
+	return doc;
+}
+
+/**
+ * @brief Returns document of primary/secondary text, creating it on first access
+ *
+ * Creating the document is rather expensive, if text is only needed for reading/exporting
+ * use text() or plainText() instead.
+ */
+RichDocument *
+SubtitleLine::doc(bool primary) const
+{
+	RichDocument *doc = primary ? m_primaryDoc : m_secondaryDoc;
+	return doc ? doc : createDoc(primary);
+}
+
+RichString
+SubtitleLine::text(bool primary) const
+{
+	if(const RichDocument *doc = primary ? m_primaryDoc : m_secondaryDoc)
+		return doc->toRichText();
+	const RichString *text = primary ? m_primaryText : m_secondaryText;
+	return text ? *text : RichString();
+}
+
+QString
+SubtitleLine::plainText(bool primary) const
+{
+	if(const RichDocument *doc = primary ? m_primaryDoc : m_secondaryDoc)
+		return doc->toPlainText();
+	const RichString *text = primary ? m_primaryText : m_secondaryText;
+	if(!text)
+		return QString();
+	// same conversions as QTextDocument::toPlainText()
+	QString plain = text->string();
+	plain.replace(QChar::Nbsp, QChar::Space);
+	plain.replace(QChar::LineSeparator, QChar::LineFeed);
+	return plain;
+}
+
+/**
+ * @brief Measures plain text the same way as character/word/line counts of a line
+ */
+SubtitleLine::TextMetrics
+SubtitleLine::measureText(const QString &plainText)
+{
+	TextMetrics metrics;
+	metrics.valid = true;
+	metrics.length = plainText.length();
+
+	const QString simplified = plainText.simplified();
+	metrics.characters = simplified.length();
+	metrics.words = simplified.isEmpty() ? 0 : simplified.count(' ') + 1;
+
+	RichString text(plainText);
+	text.simplifyWhiteSpace();
+	if(!text.isEmpty()) {
+		metrics.lines = text.count('\n') + 1;
+		metrics.durationCharacters = text.length();
+		metrics.durationWords = text.count(' ') + metrics.lines;
+	}
+
+	const QStringList lines = plainText.split(u'\n');
+	for(const QString &line: lines)
+		metrics.maxLineCharacters = qMax(metrics.maxLineCharacters, int(line.simplified().length()));
+
+	return metrics;
+}
+
+/**
+ * @brief Returns cached metrics of primary/secondary text
+ */
+const SubtitleLine::TextMetrics &
+SubtitleLine::textMetrics(bool primary) const
+{
+	TextMetrics &metrics = primary ? m_primaryMetrics : m_secondaryMetrics;
+	if(!metrics.valid)
+		metrics = measureText(plainText(primary));
+	return metrics;
+}
+
+/**
+ * @brief Sets primary/secondary text
+ *
+ * Lines that are not part of a subtitle yet (e.g. while parsing) will keep the text
+ * in compact form, otherwise text is set through the document so the change can be undone.
+ */
+void
+SubtitleLine::setText(bool primary, const RichString &text)
+{
+	if(m_subtitle || hasDoc(primary)) {
+		doc(primary)->setRichText(text);
 		return;
-	processAction(new SetLineSecondaryTextAction(this, m_secondaryDoc));
+	}
+
+	storeText(primary, text);
+	(primary ? m_primaryMetrics : m_secondaryMetrics).valid = false;
+
+	if(primary)
+		emit primaryTextChanged();
+	else
+		emit secondaryTextChanged();
+}
+
+/**
+ * @brief Approximate heap memory used by a RichDocument holding a short line of text
+ *
+ * Measured once, other threads allocating at the same time skew single measurements,
+ * so the median of a few is used.
+ */
+int
+SubtitleLine::documentMemoryUsage()
+{
+	static const int usage = [](){
+		int measured = 0;
+#ifdef HAVE_MALLINFO2
+		std::array<qint64, 5> samples;
+		for(qint64 &sample: samples) {
+			const size_t before = mallinfo2().uordblks;
+			RichDocument *doc = new RichDocument();
+			doc->setPlainText(QStringLiteral("Subtitle line"), true);
+			sample = qint64(mallinfo2().uordblks) - qint64(before);
+			delete doc;
+		}
+		std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+		measured = int(qMax<qint64>(0, samples[samples.size() / 2]));
+#endif
+		// lower bound - QTextDocument internals are not accounted for
+		return qMax(measured, int(sizeof(RichDocument)));
+	}();
+	return usage;
+}
+
+/**
+ * @brief Estimated memory saved by not having documents created for this line
+ */
+int
+SubtitleLine::compactMemorySaved() const
+{
+	int saved = 0;
+	if(!m_primaryDoc)
+		saved += documentMemoryUsage();
+	if(!m_secondaryDoc)
+		saved += documentMemoryUsage();
+	return saved;
+}
+
+/**
+ * @brief Approximate heap memory used by the line and its texts
+ */
+size_t
+SubtitleLine::memoryUsage() const
+{
+	size_t usage = sizeof(SubtitleLine);
+	for(const bool primary: {true, false}) {
+		if(const RichDocument *doc = primary ? m_primaryDoc : m_secondaryDoc)
+			usage += documentMemoryUsage() + doc->characterCount() * sizeof(QChar);
+		if(const RichString *text = primary ? m_primaryText : m_secondaryText)
+			usage += text->memoryUsage();
+	}
+	return usage;
+}
+
+/**
+ * @brief Replaces documents with compact text
+ */
+void
+SubtitleLine::compactTexts()
+{
+	for(const bool primary: {true, false}) {
+		RichDocument *&doc = primary ? m_primaryDoc : m_secondaryDoc;
+		if(!doc)
+			continue;
+		storeText(primary, doc->toRichText(), false);
+		delete doc;
+		doc = nullptr;
+	}
+}
+
+/**
+ * @brief Keeps a copy of text in compact form, empty text is not allocated
+ * @param changed false when the same text is only moved between document and compact form
+ */
+void
+SubtitleLine::storeText(bool primary, const RichString &text, bool changed) const
+{
+	if(changed)
+		(primary ? m_primaryRevision : m_secondaryRevision) = ++lastTextRevision;
+
+	RichString *&compact = primary ? m_primaryText : m_secondaryText;
+	if(text.isEmpty()) {
+		delete compact;
+		compact = nullptr;
+	} else if(compact) {
+		*compact = text;
+	} else {
+		compact = new RichString(text);
+	}
+}
+
+/**
+ * @brief Moves text from other line without creating documents when possible
+ *
+ * Text of @p from is left empty, unless it's copied between texts of the same line.
+ */
+void
+SubtitleLine::moveText(bool primary, SubtitleLine *from, bool fromPrimary)
+{
+	if(from->hasDoc(fromPrimary) || hasDoc(primary)) {
+		if(primary)
+			setPrimaryDoc(from->doc(fromPrimary));
+		else
+			setSecondaryDoc(from->doc(fromPrimary));
+		return;
+	}
+
+	RichString *&text = primary ? m_primaryText : m_secondaryText;
+	RichString *&fromText = fromPrimary ? from->m_primaryText : from->m_secondaryText;
+	if(&text == &fromText)
+		return;
+	delete text;
+	if(from == this) {
+		text = fromText ? new RichString(*fromText) : nullptr;
+	} else {
+		text = fromText;
+		fromText = nullptr;
+		(fromPrimary ? from->m_primaryRevision : from->m_secondaryRevision) = ++lastTextRevision;
+	}
+	(primary ? m_primaryMetrics : m_secondaryMetrics).valid = false;
+	(primary ? m_primaryRevision : m_secondaryRevision) = ++lastTextRevision;
+
+	if(primary)
+		emit primaryTextChanged();
+	else
+		emit secondaryTextChanged();
 }
 
 void
@@ -274,8 +598,11 @@ SubtitleLine::setPrimaryDoc(RichDocument *doc)
 		m_primaryDoc->setStylesheet(nullptr);
 	}
 	m_primaryDoc = doc;
+	m_primaryMetrics.valid = false;
 	m_primaryDoc->setParent(this);
+	m_primaryDoc->setUndoRedoEnabled(false);
 	m_primaryDoc->setStylesheet(m_subtitle ? m_subtitle->m_stylesheet : nullptr);
+	storeText(true, m_primaryDoc->toRichText());
 	connect(m_primaryDoc, &RichDocument::contentsChanged, this, &SubtitleLine::primaryDocumentChanged);
 }
 
@@ -289,8 +616,11 @@ SubtitleLine::setSecondaryDoc(RichDocument *doc)
 		m_secondaryDoc->setStylesheet(nullptr);
 	}
 	m_secondaryDoc = doc;
+	m_secondaryMetrics.valid = false;
 	m_secondaryDoc->setParent(this);
+	m_secondaryDoc->setUndoRedoEnabled(false);
 	m_secondaryDoc->setStylesheet(m_subtitle ? m_subtitle->m_stylesheet : nullptr);
+	storeText(false, m_secondaryDoc->toRichText());
 	connect(m_secondaryDoc, &RichDocument::contentsChanged, this, &SubtitleLine::secondaryDocumentChanged);
 }
 
@@ -306,14 +636,14 @@ SubtitleLine::breakText(int minBreakLength, SubtitleTarget target)
 {
 	switch(target) {
 	case Primary:
-		m_primaryDoc->breakText(minBreakLength);
+		primaryDoc()->breakText(minBreakLength);
 		break;
 	case Secondary:
-		m_secondaryDoc->breakText(minBreakLength);
+		secondaryDoc()->breakText(minBreakLength);
 		break;
 	case Both:
-		m_primaryDoc->breakText(minBreakLength);
-		m_secondaryDoc->breakText(minBreakLength);
+		primaryDoc()->breakText(minBreakLength);
+		secondaryDoc()->breakText(minBreakLength);
 		break;
 	default:
 		break;
@@ -325,14 +655,14 @@ SubtitleLine::unbreakText(SubtitleTarget target)
 {
 	switch(target) {
 	case Primary:
-		m_primaryDoc->joinLines();
+		primaryDoc()->joinLines();
 		break;
 	case Secondary:
-		m_secondaryDoc->joinLines();
+		secondaryDoc()->joinLines();
 		break;
 	case Both:
-		m_primaryDoc->joinLines();
-		m_secondaryDoc->joinLines();
+		primaryDoc()->joinLines();
+		secondaryDoc()->joinLines();
 		break;
 	default:
 		break;
@@ -344,14 +674,14 @@ SubtitleLine::simplifyTextWhiteSpace(SubtitleTarget target)
 {
 	switch(target) {
 	case Primary:
-		m_primaryDoc->cleanupSpaces();
+		primaryDoc()->cleanupSpaces();
 		break;
 	case Secondary:
-		m_secondaryDoc->cleanupSpaces();
+		secondaryDoc()->cleanupSpaces();
 		break;
 	case Both:
-		m_primaryDoc->cleanupSpaces();
-		m_secondaryDoc->cleanupSpaces();
+		primaryDoc()->cleanupSpaces();
+		secondaryDoc()->cleanupSpaces();
 		break;
 	default:
 		break;
@@ -417,7 +747,7 @@ SubtitleLine::setHideTime(const Time &hideTime)
 QColor
 SubtitleLine::durationColor(const QColor &textColor, bool usePrimary)
 {
-	const int textLen = (usePrimary ? primaryDoc() : secondaryDoc())->length();
+	const int textLen = textMetrics(usePrimary).length + 1; // same as QTextDocument::characterCount()
 	const int minD = textLen * SCConfig::minDurationPerCharacter();
 	const int maxD = textLen * SCConfig::maxDurationPerCharacter();
 	const int avgD = textLen * SCConfig::idealDurationPerCharacter();
@@ -466,43 +796,37 @@ SubtitleLine::setTimes(const Time &showTime, const Time &hideTime)
 int
 SubtitleLine::primaryCharacters() const
 {
-	return m_primaryDoc->toPlainText().simplified().length();
+	return textMetrics(true).characters;
 }
 
 int
 SubtitleLine::primaryWords() const
 {
-	QString text(m_primaryDoc->toPlainText().simplified());
-	return text.length() ? text.count(' ') + 1 : 0;
+	return textMetrics(true).words;
 }
 
 int
 SubtitleLine::primaryLines() const
 {
-	RichString text(m_primaryDoc->toPlainText());
-	text.simplifyWhiteSpace();
-	return text.isEmpty() ? 0 : text.count('\n') + 1;
+	return textMetrics(true).lines;
 }
 
 int
 SubtitleLine::secondaryCharacters() const
 {
-	return m_secondaryDoc->toPlainText().simplified().length();
+	return textMetrics(false).characters;
 }
 
 int
 SubtitleLine::secondaryWords() const
 {
-	QString text(m_secondaryDoc->toPlainText().simplified());
-	return text.length() ? text.count(' ') + 1 : 0;
+	return textMetrics(false).words;
 }
 
 int
 SubtitleLine::secondaryLines() const
 {
-	RichString text(m_secondaryDoc->toPlainText());
-	text.simplifyWhiteSpace();
-	return text.isEmpty() ? 0 : text.count('\n') + 1;
+	return textMetrics(false).lines;
 }
 
 Time
@@ -527,17 +851,22 @@ SubtitleLine::autoDuration(const QString &t, int msecsPerChar, int msecsPerWord,
 Time
 SubtitleLine::autoDuration(int msecsPerChar, int msecsPerWord, int msecsPerLine, SubtitleTarget calculationTarget)
 {
+	const auto duration = [&](bool primary){
+		const TextMetrics &text = textMetrics(primary);
+		return Time(text.durationCharacters * msecsPerChar + text.durationWords * msecsPerWord + text.lines * msecsPerLine);
+	};
+
 	switch(calculationTarget) {
 	case Secondary:
-		return autoDuration(m_secondaryDoc->toPlainText(), msecsPerChar, msecsPerWord, msecsPerLine);
+		return duration(false);
 	case Both: {
-		Time primary = autoDuration(m_primaryDoc->toPlainText(), msecsPerChar, msecsPerWord, msecsPerLine);
-		Time secondary = autoDuration(m_secondaryDoc->toPlainText(), msecsPerChar, msecsPerWord, msecsPerLine);
+		Time primary = duration(true);
+		Time secondary = duration(false);
 		return primary > secondary ? primary : secondary;
 	}
 	case Primary:
 	default:
-		return autoDuration(m_primaryDoc->toPlainText(), msecsPerChar, msecsPerWord, msecsPerLine);
+		return duration(true);
 	}
 }
 
@@ -597,7 +926,7 @@ SubtitleLine::setErrorFlags(int errorFlags, bool value)
 bool
 SubtitleLine::checkEmptyPrimaryText(bool update)
 {
-	bool error = m_primaryDoc->isEmpty() || m_primaryDoc->toPlainText().trimmed().isEmpty();
+	bool error = textMetrics(true).characters == 0;
 
 	if(update)
 		setErrorFlags(EmptyPrimaryText, error);
@@ -608,7 +937,7 @@ SubtitleLine::checkEmptyPrimaryText(bool update)
 bool
 SubtitleLine::checkEmptySecondaryText(bool update)
 {
-	bool error = m_secondaryDoc->isEmpty() || m_secondaryDoc->toPlainText().trimmed().isEmpty();
+	bool error = textMetrics(false).characters == 0;
 
 	if(update)
 		setErrorFlags(EmptySecondaryText, error);
@@ -619,7 +948,7 @@ SubtitleLine::checkEmptySecondaryText(bool update)
 bool
 SubtitleLine::checkUntranslatedText(bool update)
 {
-	bool error = m_primaryDoc->toPlainText() == m_secondaryDoc->toPlainText();
+	bool error = plainText(true) == plainText(false);
 
 	if(update)
 		setErrorFlags(UntranslatedText, error);
@@ -778,17 +1107,7 @@ SubtitleLine::checkMaxPrimaryCharsPerLine(int maxCharactersPerLine, bool update)
 {
 	Q_ASSERT(maxCharactersPerLine >= 0);
 
-	bool error = false;
-
-	QString text = primaryDoc()->toPlainText();
-	QStringList lines = text.split(u'\n');
-
-	for(auto line = lines.cbegin(); line != lines.cend(); ++line) {
-		if(line->simplified().length() > maxCharactersPerLine) {
-			error = true;
-			break;
-		}
-	}
+	bool error = textMetrics(true).maxLineCharacters > maxCharactersPerLine;
 
 	if(update)
 		setErrorFlags(MaxPrimaryCharsPerLine, error);
@@ -801,17 +1120,7 @@ SubtitleLine::checkMaxSecondaryCharsPerLine(int maxCharactersPerLine, bool updat
 {
 	Q_ASSERT(maxCharactersPerLine >= 0);
 
-	bool error = false;
-
-	QString text = secondaryDoc()->toPlainText();
-	QStringList lines = text.split(u'\n');
-
-	for(auto line = lines.cbegin(); line != lines.cend(); ++line) {
-		if(line->simplified().length() > maxCharactersPerLine) {
-			error = true;
-			break;
-		}
-	}
+	bool error = textMetrics(false).maxLineCharacters > maxCharactersPerLine;
 
 	if(update)
 		setErrorFlags(MaxSecondaryCharsPerLine, error);
@@ -822,9 +1131,7 @@ SubtitleLine::checkMaxSecondaryCharsPerLine(int maxCharactersPerLine, bool updat
 bool
 SubtitleLine::checkPrimaryUnneededSpaces(bool update)
 {
-	static const QRegularExpression unneededSpaceRegExp("(^\\s|\\s$|¿\\s|¡\\s|\\s\\s|\\s!|\\s\\?|\\s:|\\s;|\\s,|\\s\\.)");
-
-	bool error = m_primaryDoc->indexOf(unneededSpaceRegExp) != -1;
+	bool error = hasUnneededSpaces(plainText(true));
 
 	if(update)
 		setErrorFlags(PrimaryUnneededSpaces, error);
@@ -835,9 +1142,7 @@ SubtitleLine::checkPrimaryUnneededSpaces(bool update)
 bool
 SubtitleLine::checkSecondaryUnneededSpaces(bool update)
 {
-	static const QRegularExpression unneededSpaceRegExp("(^\\s|\\s$|¿\\s|¡\\s|\\s\\s|\\s!|\\s\\?|\\s:|\\s;|\\s,|\\s\\.)");
-
-	bool error = m_secondaryDoc->indexOf(unneededSpaceRegExp) != -1;
+	bool error = hasUnneededSpaces(plainText(false));
 
 	if(update)
 		setErrorFlags(SecondaryUnneededSpaces, error);
@@ -848,15 +1153,7 @@ SubtitleLine::checkSecondaryUnneededSpaces(bool update)
 bool
 SubtitleLine::checkPrimaryCapitalAfterEllipsis(bool update)
 {
-	staticRE$(capitalAfterEllipsisRegExp, "^\\s*\\.\\.\\.[¡¿\\.,;\\(\\[\\{\"'\\s]*", REu);
-
-	const QString text = m_primaryDoc->toPlainText();
-	QRegularExpressionMatchIterator it = capitalAfterEllipsisRegExp.globalMatch(text);
-	bool success = it.hasNext();
-	if(success) {
-		const QChar chr = text.at(it.next().capturedEnd());
-		success = chr.isLetter() && chr == chr.toUpper();
-	}
+	bool success = hasCapitalAfterEllipsis(plainText(true));
 
 	if(update)
 		setErrorFlags(PrimaryCapitalAfterEllipsis, success);
@@ -867,15 +1164,7 @@ SubtitleLine::checkPrimaryCapitalAfterEllipsis(bool update)
 bool
 SubtitleLine::checkSecondaryCapitalAfterEllipsis(bool update)
 {
-	staticRE$(capitalAfterEllipsisRegExp, "^\\s*\\.\\.\\.[¡¿\\.,;\\(\\[\\{\"'\\s]*", REu);
-
-	const QString text = m_secondaryDoc->toPlainText();
-	QRegularExpressionMatchIterator it = capitalAfterEllipsisRegExp.globalMatch(text);
-	bool success = it.hasNext();
-	if(success) {
-		const QChar chr = text.at(it.next().capturedEnd());
-		success = chr.isLetter() && chr == chr.toUpper();
-	}
+	bool success = hasCapitalAfterEllipsis(plainText(false));
 
 	if(update)
 		setErrorFlags(SecondaryCapitalAfterEllipsis, success);
@@ -886,9 +1175,7 @@ SubtitleLine::checkSecondaryCapitalAfterEllipsis(bool update)
 bool
 SubtitleLine::checkPrimaryUnneededDash(bool update)
 {
-	staticRE$(unneededDashRegExp, "(^|\n)\\s*-[^-]", REu);
-
-	bool success = m_primaryDoc->toPlainText().count(unneededDashRegExp) == 1;
+	bool success = hasUnneededDash(plainText(true));
 
 	if(update)
 		setErrorFlags(PrimaryUnneededDash, success);
@@ -899,9 +1186,7 @@ SubtitleLine::checkPrimaryUnneededDash(bool update)
 bool
 SubtitleLine::checkSecondaryUnneededDash(bool update)
 {
-	staticRE$(unneededDashRegExp, "(^|\n)\\s*-[^-]", REu);
-
-	bool success = m_secondaryDoc->toPlainText().count(unneededDashRegExp) == 1;
+	bool success = hasUnneededDash(plainText(false));
 
 	if(update)
 		setErrorFlags(SecondaryUnneededDash, success);
@@ -909,99 +1194,126 @@ SubtitleLine::checkSecondaryUnneededDash(bool update)
 	return success;
 }
 
+SubtitleLine::TextSnapshot
+SubtitleLine::textSnapshot(int errorFlagsToCheck) const
+{
+	TextSnapshot text;
+	if(errorFlagsToCheck & (PrimaryOnlyErrors | UntranslatedText))
+		text.primary = plainText(true);
+	if(errorFlagsToCheck & SecondaryOnlyErrors)
+		text.secondary = plainText(false);
+	text.duration = durationTime().toMillis();
+	return text;
+}
+
 int
-SubtitleLine::check(int errorFlagsToCheck, bool update)
+SubtitleLine::checkText(const TextSnapshot &text, int errorFlagsToCheck)
 {
-	int lineErrorFlags = m_errorFlags & ~errorFlagsToCheck; // clear the flags we're going to (re)check
+	int lineErrorFlags = 0;
+
+	const TextMetrics primary = (errorFlagsToCheck & PrimaryOnlyErrors) ? measureText(text.primary) : TextMetrics();
+	const TextMetrics secondary = (errorFlagsToCheck & SecondaryOnlyErrors) ? measureText(text.secondary) : TextMetrics();
 
 	if(errorFlagsToCheck & EmptyPrimaryText)
-		if(checkEmptyPrimaryText(false))
+		if(!primary.characters)
 			lineErrorFlags |= EmptyPrimaryText;
 
 	if(errorFlagsToCheck & EmptySecondaryText)
-		if(checkEmptySecondaryText(false))
+		if(!secondary.characters)
 			lineErrorFlags |= EmptySecondaryText;
 
-	if(errorFlagsToCheck & OverlapsWithNext)
-		if(checkOverlapsWithNext(false))
-			lineErrorFlags |= OverlapsWithNext;
-
 	if(errorFlagsToCheck & UntranslatedText)
-		if(checkUntranslatedText(false))
+		if(text.primary == text.secondary)
 			lineErrorFlags |= UntranslatedText;
 
-	if(errorFlagsToCheck & MaxDuration)
-		if(checkMaxDuration(SCConfig::maxDuration(), false))
-			lineErrorFlags |= MaxDuration;
+	if(errorFlagsToCheck & MinDurationPerPrimaryChar)
+		if(primary.characters && text.duration / primary.characters < SCConfig::minDurationPerCharacter())
+			lineErrorFlags |= MinDurationPerPrimaryChar;
 
-	if(errorFlagsToCheck & MinDuration)
-		if(checkMinDuration(SCConfig::minDuration(), false))
-			lineErrorFlags |= MinDuration;
+	if(errorFlagsToCheck & MinDurationPerSecondaryChar)
+		if(secondary.characters && text.duration / secondary.characters < SCConfig::minDurationPerCharacter())
+			lineErrorFlags |= MinDurationPerSecondaryChar;
 
 	if(errorFlagsToCheck & MaxDurationPerPrimaryChar)
-		if(checkMaxDurationPerPrimaryChar(SCConfig::maxDurationPerCharacter(), false))
+		if(primary.characters && text.duration / primary.characters > SCConfig::maxDurationPerCharacter())
 			lineErrorFlags |= MaxDurationPerPrimaryChar;
 
 	if(errorFlagsToCheck & MaxDurationPerSecondaryChar)
-		if(checkMaxDurationPerSecondaryChar(SCConfig::maxDurationPerCharacter(), false))
+		if(secondary.characters && text.duration / secondary.characters > SCConfig::maxDurationPerCharacter())
 			lineErrorFlags |= MaxDurationPerSecondaryChar;
 
-	if(errorFlagsToCheck & MinDurationPerPrimaryChar)
-		if(checkMinDurationPerPrimaryChar(SCConfig::minDurationPerCharacter(), false))
-			lineErrorFlags |= MinDurationPerPrimaryChar;
-
-	if(errorFlagsToCheck & MinDurationPerSecondaryChar)
-		if(checkMinDurationPerSecondaryChar(SCConfig::minDurationPerCharacter(), false))
-			lineErrorFlags |= MinDurationPerSecondaryChar;
-
 	if(errorFlagsToCheck & MaxPrimaryChars)
-		if(checkMaxPrimaryChars(SCConfig::maxCharacters(), false))
+		if(primary.characters > SCConfig::maxCharacters())
 			lineErrorFlags |= MaxPrimaryChars;
 
 	if(errorFlagsToCheck & MaxSecondaryChars)
-		if(checkMaxSecondaryChars(SCConfig::maxCharacters(), false))
+		if(secondary.characters > SCConfig::maxCharacters())
 			lineErrorFlags |= MaxSecondaryChars;
 
 	if(errorFlagsToCheck & MaxPrimaryLines)
-		if(checkMaxPrimaryLines(SCConfig::maxLines(), false))
+		if(primary.lines > SCConfig::maxLines())
 			lineErrorFlags |= MaxPrimaryLines;
 
 	if(errorFlagsToCheck & MaxSecondaryLines)
-		if(checkMaxSecondaryLines(SCConfig::maxLines(), false))
+		if(secondary.lines > SCConfig::maxLines())
 			lineErrorFlags |= MaxSecondaryLines;
 
 	if(errorFlagsToCheck & MaxPrimaryCharsPerLine)
-		if(checkMaxPrimaryCharsPerLine(SCConfig::maxCharactersPerLine(), false))
+		if(primary.maxLineCharacters > SCConfig::maxCharactersPerLine())
 			lineErrorFlags |= MaxPrimaryCharsPerLine;
 
 	if(errorFlagsToCheck & MaxSecondaryCharsPerLine)
-		if(checkMaxSecondaryCharsPerLine(SCConfig::maxCharactersPerLine(), false))
+		if(secondary.maxLineCharacters > SCConfig::maxCharactersPerLine())
 			lineErrorFlags |= MaxSecondaryCharsPerLine;
 
 	if(errorFlagsToCheck & PrimaryUnneededSpaces)
-		if(checkPrimaryUnneededSpaces(false))
+		if(hasUnneededSpaces(text.primary))
 			lineErrorFlags |= PrimaryUnneededSpaces;
 
 	if(errorFlagsToCheck & SecondaryUnneededSpaces)
-		if(checkSecondaryUnneededSpaces(false))
+		if(hasUnneededSpaces(text.secondary))
 			lineErrorFlags |= SecondaryUnneededSpaces;
 
 	if(errorFlagsToCheck & PrimaryCapitalAfterEllipsis)
-		if(checkPrimaryCapitalAfterEllipsis(false))
+		if(hasCapitalAfterEllipsis(text.primary))
 			lineErrorFlags |= PrimaryCapitalAfterEllipsis;
 
 	if(errorFlagsToCheck & SecondaryCapitalAfterEllipsis)
-		if(checkSecondaryCapitalAfterEllipsis(false))
+		if(hasCapitalAfterEllipsis(text.secondary))
 			lineErrorFlags |= SecondaryCapitalAfterEllipsis;
 
 	if(errorFlagsToCheck & PrimaryUnneededDash)
-		if(checkPrimaryUnneededDash(false))
+		if(hasUnneededDash(text.primary))
 			lineErrorFlags |= PrimaryUnneededDash;
 
 	if(errorFlagsToCheck & SecondaryUnneededDash)
-		if(checkSecondaryUnneededDash(false))
+		if(hasUnneededDash(text.secondary))
 			lineErrorFlags |= SecondaryUnneededDash;
 
+	return lineErrorFlags;
+}
+
+int
+SubtitleLine::check(int errorFlagsToCheck, bool update)
+{
+	int lineErrorFlags = m_errorFlags & ~errorFlagsToCheck; // clear the flags we're going to (re)check
+
+	if(errorFlagsToCheck & OverlapsWithNext)
+		if(checkOverlapsWithNext(false))
+			lineErrorFlags |= OverlapsWithNext;
+
+	if(errorFlagsToCheck & MaxDuration)
+		if(checkMaxDuration(SCConfig::maxDuration(), false))
+			lineErrorFlags |= MaxDuration;
+
+	if(errorFlagsToCheck & MinDuration)
+		if(checkMinDuration(SCConfig::minDuration(), false))
+			lineErrorFlags |= MinDuration;
+
+	// texts are converted only once for all text checks
+	if(errorFlagsToCheck & TextErrors)
+		lineErrorFlags |= checkText(textSnapshot(errorFlagsToCheck), errorFlagsToCheck & TextErrors);
+
 	if(update)
 		setErrorFlags(lineErrorFlags);
 
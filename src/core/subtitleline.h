@@ -44,7 +44,9 @@ class SubtitleLine : public QObject
 	friend class Subtitle;
 	friend class SubtitleAction;
 	friend class SwapLinesTextsAction;
+	friend class TransformTimesAction;
 	friend class SubtitleLineAction;
+	friend class LineTextAction;
 	friend class SetLinePrimaryTextAction;
 	friend class SetLineSecondaryTextAction;
 	friend class SetLineTextsAction;
@@ -147,9 +149,29 @@ public:
 	inline SubtitleLine * prevLine() const;
 	inline SubtitleLine * nextLine() const;
 
-	inline RichDocument * doc(bool primary) const { return primary ? m_primaryDoc : m_secondaryDoc; }
-	inline RichDocument * primaryDoc() const { return m_primaryDoc; }
-	inline RichDocument * secondaryDoc() const { return m_secondaryDoc; }
+	RichDocument * doc(bool primary) const;
+	inline RichDocument * primaryDoc() const { return doc(true); }
+	inline RichDocument * secondaryDoc() const { return doc(false); }
+	inline bool hasDoc(bool primary) const { return primary ? m_primaryDoc : m_secondaryDoc; }
+	/**
+	 * @brief Revision of primary/secondary text, it changes with the text and is unique among all lines
+	 */
+	inline quint64 textRevision(bool primary) const { return primary ? m_primaryRevision : m_secondaryRevision; }
+
+	RichString text(bool primary) const;
+	inline RichString primaryText() const { return text(true); }
+	inline RichString secondaryText() const { return text(false); }
+	QString plainText(bool primary) const;
+	inline QString primaryPlainText() const { return plainText(true); }
+	inline QString secondaryPlainText() const { return plainText(false); }
+
+	void setText(bool primary, const RichString &text);
+	inline void setPrimaryText(const RichString &text) { setText(true, text); }
+	inline void setSecondaryText(const RichString &text) { setText(false, text); }
+
+	static int documentMemoryUsage();
+	int compactMemorySaved() const;
+	size_t memoryUsage() const;
 
 	void breakText(int minBreakLength, SubtitleTarget target);
 	void unbreakText(SubtitleTarget target);
@@ -173,6 +195,23 @@ public:
 	inline bool containsTime(const Time &time) const { return m_showTime <= time && time <= m_hideTime; }
 	inline bool intersectsTimespan(const Time &start, const Time &end) const { return m_showTime <= end && start <= m_hideTime; }
 
+	/**
+	 * @brief Character, word and line counts of plain text
+	 */
+	struct TextMetrics {
+		bool valid = false;
+		int length = 0;
+		int characters = 0;
+		int words = 0;
+		int lines = 0;
+		int maxLineCharacters = 0;
+		// as counted by autoDuration()
+		int durationCharacters = 0;
+		int durationWords = 0;
+	};
+	static TextMetrics measureText(const QString &plainText);
+	const TextMetrics & textMetrics(bool primary) const;
+
 	int primaryCharacters() const;
 	int primaryWords() const;
 	int primaryLines() const;
@@ -221,6 +260,22 @@ public:
 
 	int check(int errorFlagsToCheck, bool update = true);
 
+	/**
+	 * @brief Plain texts and duration of a line, all that is needed to check its text errors
+	 */
+	struct TextSnapshot {
+		QString primary;
+		QString secondary;
+		double duration = 0.;
+	};
+	TextSnapshot textSnapshot(int errorFlagsToCheck) const;
+	/**
+	 * @brief Returns which of @p errorFlagsToCheck text errors are present in @p text
+	 *
+	 * Doesn't touch the line or its documents, so it's safe to call from worker threads.
+	 */
+	static int checkText(const TextSnapshot &text, int errorFlagsToCheck);
+
 	inline bool metaExists(const QByteArray &key) const { return m_metaData.contains(key); }
 	inline int metaRemove(const QByteArray &key) { return m_metaData.remove(key); }
 	inline const QString meta(const QByteArray &key) const { return m_metaData.value(key); }
@@ -244,9 +299,14 @@ private:
 	void processAction(UndoAction *action);
 	void processShowTimeSort(const Time &showTime);
 
+	RichDocument * createDoc(bool primary) const;
 	void setPrimaryDoc(RichDocument *doc);
 	void setSecondaryDoc(RichDocument *doc);
+	void moveText(bool primary, SubtitleLine *from, bool fromPrimary);
+	void compactTexts();
 	void setTexts(RichDocument *pText, RichDocument *sText);
+	void storeText(bool primary, const RichString &text, bool changed = true) const;
+	void documentChanged(bool primary);
 	void primaryDocumentChanged();
 	void secondaryDocumentChanged();
 
@@ -260,8 +320,16 @@ private:
 
 private:
 	QExplicitlySharedDataPointer<Subtitle> m_subtitle;
-	RichDocument *m_primaryDoc;
-	RichDocument *m_secondaryDoc;
+	// documents are created on first access, until then text is kept in m_primaryText/m_secondaryText,
+	// once document exists they hold its last known text which line text actions are computed against
+	mutable RichDocument *m_primaryDoc;
+	mutable RichDocument *m_secondaryDoc;
+	mutable RichString *m_primaryText = nullptr;
+	mutable RichString *m_secondaryText = nullptr;
+	mutable quint64 m_primaryRevision = 0;
+	mutable quint64 m_secondaryRevision = 0;
+	mutable TextMetrics m_primaryMetrics;
+	mutable TextMetrics m_secondaryMetrics;
 	Time m_showTime;
 	Time m_hideTime;
 	int m_errorFlags;
@@ -0,0 +1,159 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "subtitletimeindex.h"
+
+#include "core/subtitle.h"
+#include "core/subtitleline.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace SubtitleComposer;
+
+SubtitleTimeIndex::SubtitleTimeIndex(Subtitle *subtitle)
+	: m_subtitle(subtitle),
+	  m_valid(false),
+	  m_linesOrder(false),
+	  m_leafCount(0)
+{
+}
+
+void
+SubtitleTimeIndex::invalidate()
+{
+	m_valid = false;
+}
+
+void
+SubtitleTimeIndex::build() const
+{
+	const int n = m_subtitle->count();
+	const double *showTimes = m_subtitle->times().showTimes();
+	const double *hideTimes = m_subtitle->times().hideTimes();
+
+	m_entries.clear();
+	m_entries.reserve(n);
+	m_linesOrder = true;
+	for(int i = 0; i < n; i++) {
+		if(i && showTimes[i] < showTimes[i - 1])
+			m_linesOrder = false;
+		m_entries.push_back(Entry{showTimes[i], m_subtitle->at(i)});
+	}
+	if(!m_linesOrder) {
+		std::stable_sort(m_entries.begin(), m_entries.end(), [](const Entry &e1, const Entry &e2){
+			return e1.showTime < e2.showTime;
+		});
+	}
+
+	m_leafCount = 1;
+	while(m_leafCount < quint32(n))
+		m_leafCount <<= 1;
+	m_maxHideTime.assign(m_leafCount << 1, std::numeric_limits<double>::lowest());
+	if(m_linesOrder) {
+		std::copy(hideTimes, hideTimes + n, m_maxHideTime.begin() + m_leafCount);
+	} else {
+		for(int i = 0; i < n; i++)
+			m_maxHideTime[m_leafCount + i] = m_entries[i].line->hideTime().toMillis();
+	}
+	for(quint32 node = m_leafCount - 1; node > 0; node--)
+		m_maxHideTime[node] = qMax(m_maxHideTime[node << 1], m_maxHideTime[(node << 1) | 1]);
+
+	m_valid = true;
+}
+
+int
+SubtitleTimeIndex::position(const SubtitleLine *line) const
+{
+	if(m_linesOrder) {
+		const int index = line->index();
+		return index >= 0 && size_t(index) < m_entries.size() && m_entries[index].line == line ? index : -1;
+	}
+
+	// show time of the line is the same as when it was indexed
+	const double showTime = line->showTime().toMillis();
+	auto it = std::lower_bound(m_entries.cbegin(), m_entries.cend(), showTime, [](const Entry &e, double t){
+		return e.showTime < t;
+	});
+	for(; it != m_entries.cend() && it->showTime == showTime; ++it) {
+		if(it->line == line)
+			return it - m_entries.cbegin();
+	}
+	return -1;
+}
+
+void
+SubtitleTimeIndex::updateShowTime(const SubtitleLine *line)
+{
+	if(!m_valid)
+		return;
+
+	const int pos = position(line);
+	const double showTime = line->showTime().toMillis();
+	if(pos < 0
+		|| (pos > 0 && showTime < m_entries[pos - 1].showTime)
+		|| (size_t(pos) + 1 < m_entries.size() && m_entries[pos + 1].showTime < showTime)) {
+		// line changed its place among others
+		invalidate();
+		return;
+	}
+
+	m_entries[pos].showTime = showTime;
+}
+
+void
+SubtitleTimeIndex::updateHideTime(const SubtitleLine *line)
+{
+	if(!m_valid)
+		return;
+
+	const int pos = position(line);
+	if(pos < 0)
+		invalidate();
+	else
+		setHideTime(pos, line->hideTime().toMillis());
+}
+
+void
+SubtitleTimeIndex::setHideTime(int pos, double hideTime)
+{
+	quint32 node = m_leafCount + pos;
+	m_maxHideTime[node] = hideTime;
+	for(node >>= 1; node > 0; node >>= 1)
+		m_maxHideTime[node] = qMax(m_maxHideTime[node << 1], m_maxHideTime[(node << 1) | 1]);
+}
+
+void
+SubtitleTimeIndex::collect(quint32 node, quint32 nodeStart, quint32 nodeSize, quint32 count, double start, QVector<SubtitleLine *> *lines) const
+{
+	// skip subtrees past the lines that show after the span, or with all lines hidden before it
+	if(nodeStart >= count || m_maxHideTime[node] < start)
+		return;
+
+	if(nodeSize == 1) {
+		lines->push_back(m_entries[nodeStart].line);
+		return;
+	}
+
+	nodeSize >>= 1;
+	collect(node << 1, nodeStart, nodeSize, count, start, lines);
+	collect((node << 1) | 1, nodeStart + nodeSize, nodeSize, count, start, lines);
+}
+
+QVector<SubtitleLine *>
+SubtitleTimeIndex::overlapping(double start, double end) const
+{
+	if(!m_valid)
+		build();
+
+	QVector<SubtitleLine *> lines;
+	const quint32 count = std::upper_bound(m_entries.cbegin(), m_entries.cend(), end, [](double t, const Entry &e){
+		return t < e.showTime;
+	}) - m_entries.cbegin();
+	if(count)
+		collect(1, 0, m_leafCount, count, start, &lines);
+	return lines;
+}
@@ -0,0 +1,61 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef SUBTITLETIMEINDEX_H
+#define SUBTITLETIMEINDEX_H
+
+#include <vector>
+
+#include <QVector>
+
+namespace SubtitleComposer {
+class Subtitle;
+class SubtitleLine;
+
+/**
+ * @brief Interval index over show/hide times of subtitle lines
+ *
+ * Lines are kept sorted by show time with a max hide time tree on top of them, so lines overlapping
+ * any time span are found without visiting the ones that don't. Time changes that keep the order of
+ * lines are applied in place, anything else rebuilds the index on next query.
+ */
+class SubtitleTimeIndex
+{
+public:
+	explicit SubtitleTimeIndex(Subtitle *subtitle);
+
+	void invalidate();
+	void updateShowTime(const SubtitleLine *line);
+	void updateHideTime(const SubtitleLine *line);
+
+	/**
+	 * @brief Lines with show time <= @p end and hide time >= @p start, ordered by show time
+	 */
+	QVector<SubtitleLine *> overlapping(double start, double end) const;
+
+private:
+	struct Entry {
+		double showTime;
+		SubtitleLine *line;
+	};
+
+	void build() const;
+	int position(const SubtitleLine *line) const;
+	void setHideTime(int pos, double hideTime);
+	void collect(quint32 node, quint32 nodeStart, quint32 nodeSize, quint32 count, double start, QVector<SubtitleLine *> *lines) const;
+
+	Subtitle *m_subtitle;
+
+	mutable bool m_valid;
+	// true when entries are in the same order as subtitle lines
+	mutable bool m_linesOrder;
+	mutable std::vector<Entry> m_entries;
+	mutable quint32 m_leafCount;
+	mutable std::vector<double> m_maxHideTime; // implicit binary tree, leaves start at m_leafCount
+};
+}
+
+#endif // SUBTITLETIMEINDEX_H
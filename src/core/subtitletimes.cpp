@@ -0,0 +1,155 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "subtitletimes.h"
+
+#include "core/subtitle.h"
+#include "core/subtitleline.h"
+
+#include <algorithm>
+
+using namespace SubtitleComposer;
+
+SubtitleTimes::SubtitleTimes(const Subtitle *subtitle)
+	: m_subtitle(subtitle),
+	  m_valid(false)
+{
+}
+
+void
+SubtitleTimes::invalidate()
+{
+	m_valid = false;
+}
+
+void
+SubtitleTimes::build() const
+{
+	const int n = m_subtitle->count();
+	m_showTimes.resize(n);
+	m_hideTimes.resize(n);
+	for(int i = 0; i < n; i++) {
+		const SubtitleLine *line = m_subtitle->at(i);
+		m_showTimes[i] = line->showTime().toMillis();
+		m_hideTimes[i] = line->hideTime().toMillis();
+	}
+	m_valid = true;
+}
+
+void
+SubtitleTimes::insertLines(int firstIndex, int lastIndex)
+{
+	if(!m_valid)
+		return;
+
+	const int n = lastIndex - firstIndex + 1;
+	m_showTimes.insert(m_showTimes.begin() + firstIndex, n, 0.);
+	m_hideTimes.insert(m_hideTimes.begin() + firstIndex, n, 0.);
+	updateLines(firstIndex, lastIndex);
+}
+
+void
+SubtitleTimes::removeLines(int firstIndex, int lastIndex)
+{
+	if(!m_valid)
+		return;
+
+	m_showTimes.erase(m_showTimes.begin() + firstIndex, m_showTimes.begin() + lastIndex + 1);
+	m_hideTimes.erase(m_hideTimes.begin() + firstIndex, m_hideTimes.begin() + lastIndex + 1);
+}
+
+void
+SubtitleTimes::updateLines(int firstIndex, int lastIndex)
+{
+	if(!m_valid)
+		return;
+
+	for(int i = firstIndex; i <= lastIndex; i++) {
+		const SubtitleLine *line = m_subtitle->at(i);
+		m_showTimes[i] = line->showTime().toMillis();
+		m_hideTimes[i] = line->hideTime().toMillis();
+	}
+}
+
+void
+SubtitleTimes::updateShowTime(const SubtitleLine *line)
+{
+	if(!m_valid)
+		return;
+
+	const int index = line->index();
+	if(index >= 0 && size_t(index) < m_showTimes.size())
+		m_showTimes[index] = line->showTime().toMillis();
+	else
+		invalidate();
+}
+
+void
+SubtitleTimes::updateHideTime(const SubtitleLine *line)
+{
+	if(!m_valid)
+		return;
+
+	const int index = line->index();
+	if(index >= 0 && size_t(index) < m_hideTimes.size())
+		m_hideTimes[index] = line->hideTime().toMillis();
+	else
+		invalidate();
+}
+
+int
+SubtitleTimes::upperBound(double time, int start, int end) const
+{
+	const double *showTimes = this->showTimes();
+	return std::upper_bound(showTimes + start, showTimes + end, time) - showTimes;
+}
+
+// loops below have no dependencies between iterations and no early exits, so compiler can vectorize them
+
+void
+SubtitleTimes::fixOverlaps(const double *showTimes, const double *hideTimes, int count, double minInterval, double *newHideTimes)
+{
+	for(int i = 0; i < count - 1; i++) {
+		const double limit = showTimes[i + 1] - minInterval;
+		newHideTimes[i] = hideTimes[i] >= limit ? std::max(limit, showTimes[i]) : hideTimes[i];
+	}
+	if(count > 0)
+		newHideTimes[count - 1] = hideTimes[count - 1];
+}
+
+void
+SubtitleTimes::maximizeDurations(const double *showTimes, const double *hideTimes, int count, double *newHideTimes)
+{
+	for(int i = 0; i < count - 1; i++) {
+		const double limit = showTimes[i + 1] - 1.;
+		newHideTimes[i] = hideTimes[i] < showTimes[i + 1] ? limit : hideTimes[i];
+	}
+	if(count > 0)
+		newHideTimes[count - 1] = hideTimes[count - 1];
+}
+
+void
+SubtitleTimes::limitDurations(const double *showTimes, const double *hideTimes, int count, double minDuration, double maxDuration, bool canOverlap, double *newHideTimes)
+{
+	if(count <= 0)
+		return;
+
+	for(int i = 0; i < count - 1; i++) {
+		const double show = showTimes[i];
+		const double hide = hideTimes[i];
+		const double next = showTimes[i + 1];
+		const double duration = hide - show;
+		// when min duration would overlap next line, make duration as big as possible without overlap
+		const double minHide = canOverlap || show + minDuration < next ? show + minDuration : (hide < next ? next - 1. : hide);
+		newHideTimes[i] = duration > maxDuration ? show + maxDuration : (duration < minDuration ? minHide : hide);
+	}
+
+	// the last line doesn't have risk of overlapping
+	const double show = showTimes[count - 1];
+	const double hide = hideTimes[count - 1];
+	const double duration = hide - show;
+	newHideTimes[count - 1] = duration > maxDuration ? show + maxDuration : (duration < minDuration ? show + minDuration : hide);
+}
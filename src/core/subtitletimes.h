@@ -0,0 +1,66 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef SUBTITLETIMES_H
+#define SUBTITLETIMES_H
+
+#include <vector>
+
+namespace SubtitleComposer {
+class Subtitle;
+class SubtitleLine;
+
+/**
+ * @brief Show and hide times of subtitle lines in contiguous arrays
+ *
+ * Mirrors times of lines in subtitle order and is kept in sync by subtitle signals, so timing passes
+ * over many lines can run over plain arrays instead of dereferencing every line.
+ */
+class SubtitleTimes
+{
+public:
+	explicit SubtitleTimes(const Subtitle *subtitle);
+
+	void invalidate();
+	void insertLines(int firstIndex, int lastIndex);
+	void removeLines(int firstIndex, int lastIndex);
+	void updateLines(int firstIndex, int lastIndex);
+	void updateShowTime(const SubtitleLine *line);
+	void updateHideTime(const SubtitleLine *line);
+
+	inline const double * showTimes() const { if(!m_valid) build(); return m_showTimes.data(); }
+	inline const double * hideTimes() const { if(!m_valid) build(); return m_hideTimes.data(); }
+
+	/**
+	 * @brief Index of first line in [start, end) that shows after @p time, lines are expected to be sorted
+	 */
+	int upperBound(double time, int start, int end) const;
+
+	/**
+	 * @brief Hide times that leave at least @p minInterval between each of @p count - 1 lines and the line after it
+	 */
+	static void fixOverlaps(const double *showTimes, const double *hideTimes, int count, double minInterval, double *newHideTimes);
+	/**
+	 * @brief Hide times that extend each of @p count - 1 lines to 1ms before the line after it
+	 */
+	static void maximizeDurations(const double *showTimes, const double *hideTimes, int count, double *newHideTimes);
+	/**
+	 * @brief Hide times that keep durations of @p count lines within limits, last line is not checked for overlap
+	 */
+	static void limitDurations(const double *showTimes, const double *hideTimes, int count, double minDuration, double maxDuration, bool canOverlap, double *newHideTimes);
+
+private:
+	void build() const;
+
+	const Subtitle *m_subtitle;
+
+	mutable bool m_valid;
+	mutable std::vector<double> m_showTimes;
+	mutable std::vector<double> m_hideTimes;
+};
+}
+
+#endif // SUBTITLETIMES_H
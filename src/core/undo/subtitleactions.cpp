@@ -16,6 +16,8 @@
 
 #include <KLocalizedString>
 
+#include <vector>
+
 using namespace SubtitleComposer;
 
 // *** SubtitleAction
@@ -88,15 +90,11 @@ InsertLinesAction::redo()
 {
 	emit m_subtitle->linesAboutToBeInserted(m_insertIndex, m_lastIndex);
 
-	SubtitleLine *line;
-	int insertOffset = 0;
-
-	while(!m_lines.isEmpty()) {
-		line = m_lines.takeFirst();
-		auto pos = m_subtitle->m_lines.cbegin() + m_insertIndex + insertOffset++;
+	// lines must know their subtitle before they're placed in its container
+	for(SubtitleLine *line: qAsConst(m_lines))
 		setLineSubtitle(line);
-		m_subtitle->m_lines.insert(pos, line);
-	}
+	m_subtitle->m_lines.insert(m_subtitle->m_lines.cbegin() + m_insertIndex, m_lines.cbegin(), m_lines.cend());
+	m_lines.clear();
 
 	emit m_subtitle->linesInserted(m_insertIndex, m_lastIndex);
 }
@@ -106,15 +104,27 @@ InsertLinesAction::undo()
 {
 	emit m_subtitle->linesAboutToBeRemoved(m_insertIndex, m_lastIndex);
 
-	for(int index = m_insertIndex; index <= m_lastIndex; ++index) {
-		SubtitleLine *line = m_subtitle->takeAt(m_insertIndex);
+	const auto first = m_subtitle->m_lines.cbegin() + m_insertIndex;
+	const auto last = m_subtitle->m_lines.cbegin() + m_lastIndex + 1;
+	for(auto it = first; it != last; ++it) {
+		SubtitleLine *line = it->obj();
 		clearLineSubtitle(line);
 		m_lines.append(line);
 	}
+	m_subtitle->m_lines.erase(first, last);
 
 	emit m_subtitle->linesRemoved(m_insertIndex, m_lastIndex);
 }
 
+size_t
+InsertLinesAction::memoryUsage() const
+{
+	size_t usage = sizeof(*this);
+	for(const SubtitleLine *line: m_lines)
+		usage += line->memoryUsage();
+	return usage;
+}
+
 
 // *** RemoveLinesAction
 RemoveLinesAction::RemoveLinesAction(Subtitle *subtitle, int firstIndex, int lastIndex)
@@ -192,6 +202,29 @@ RemoveLinesAction::undo()
 	emit m_subtitle->linesInserted(m_firstIndex, m_lastIndex);
 }
 
+size_t
+RemoveLinesAction::memoryUsage() const
+{
+	size_t usage = sizeof(*this);
+	for(const SubtitleLine *line: m_lines)
+		usage += line->memoryUsage();
+	return usage;
+}
+
+void
+RemoveLinesAction::compact()
+{
+	for(SubtitleLine *line: qAsConst(m_lines))
+		compactLineTexts(line);
+}
+
+void
+RemoveLinesAction::release()
+{
+	qDeleteAll(m_lines);
+	m_lines.clear();
+}
+
 
 // *** MoveLineAction
 MoveLineAction::MoveLineAction(Subtitle *subtitle, int fromIndex, int toIndex) :
@@ -278,6 +311,139 @@ MoveLineAction::undo()
 }
 
 
+// *** PermuteLinesAction
+PermuteLinesAction::PermuteLinesAction(Subtitle *subtitle, int firstIndex, const QVector<int> &permutation) :
+	SubtitleAction(subtitle, UndoStack::Both, i18n("Reorder Lines")),
+	m_firstIndex(firstIndex),
+	m_permutation(permutation)
+{
+	Q_ASSERT(m_firstIndex >= 0);
+	Q_ASSERT(m_firstIndex + m_permutation.size() <= m_subtitle->linesCount());
+}
+
+PermuteLinesAction::~PermuteLinesAction()
+{}
+
+void
+PermuteLinesAction::permute(bool inverse)
+{
+	const int n = m_permutation.size();
+	if(!n)
+		return;
+
+	std::vector<SubtitleLine *> lines(n);
+	for(int i = 0; i < n; i++) {
+		if(inverse)
+			lines[m_permutation.at(i)] = m_subtitle->at(m_firstIndex + i);
+		else
+			lines[i] = m_subtitle->at(m_firstIndex + m_permutation.at(i));
+	}
+
+	emit m_subtitle->linesAboutToBeReordered(m_firstIndex, m_firstIndex + n - 1);
+
+	// lines stay in subtitle, assigning them updates their index references
+	for(int i = 0; i < n; i++)
+		m_subtitle->m_lines[m_firstIndex + i] = lines[i];
+
+	emit m_subtitle->linesReordered(m_firstIndex, m_firstIndex + n - 1);
+}
+
+void
+PermuteLinesAction::redo()
+{
+	permute(false);
+}
+
+void
+PermuteLinesAction::undo()
+{
+	permute(true);
+}
+
+size_t
+PermuteLinesAction::memoryUsage() const
+{
+	return sizeof(*this) + m_permutation.size() * sizeof(int);
+}
+
+
+// *** TransformTimesAction
+TransformTimesAction::TransformTimesAction(Subtitle *subtitle, const RangeList &ranges, double shiftMseconds, double scaleFactor) :
+	SubtitleAction(subtitle, UndoStack::Both, i18n("Transform Line Times")),
+	m_ranges(ranges),
+	m_shiftMseconds(shiftMseconds),
+	m_scaleFactor(scaleFactor)
+{
+	Q_ASSERT(m_scaleFactor > 0.);
+}
+
+TransformTimesAction::~TransformTimesAction()
+{}
+
+void
+TransformTimesAction::redo()
+{
+	m_inexactTimes.clear();
+	if(m_subtitle->isEmpty())
+		return;
+
+	for(const Range &range: m_ranges) {
+		const int firstIndex = range.start();
+		const int lastIndex = m_subtitle->normalizeRangeIndex(range.end());
+		if(firstIndex > lastIndex)
+			continue;
+
+		for(int i = firstIndex; i <= lastIndex; i++) {
+			SubtitleLine *line = m_subtitle->at(i);
+			const double showTime = line->m_showTime.toMillis();
+			const double hideTime = line->m_hideTime.toMillis();
+			line->m_showTime = Time(transformed(showTime));
+			line->m_hideTime = Time(transformed(hideTime));
+			// rounding or clamping at zero would make undo inexact
+			if(inverse(line->m_showTime.toMillis()) != showTime || inverse(line->m_hideTime.toMillis()) != hideTime)
+				m_inexactTimes.push_back(LineTimes{i, showTime, hideTime});
+		}
+
+		emit m_subtitle->linesTimesChanged(firstIndex, lastIndex);
+	}
+}
+
+void
+TransformTimesAction::undo()
+{
+	if(m_subtitle->isEmpty())
+		return;
+
+	auto inexact = m_inexactTimes.cbegin();
+	for(const Range &range: m_ranges) {
+		const int firstIndex = range.start();
+		const int lastIndex = m_subtitle->normalizeRangeIndex(range.end());
+		if(firstIndex > lastIndex)
+			continue;
+
+		for(int i = firstIndex; i <= lastIndex; i++) {
+			SubtitleLine *line = m_subtitle->at(i);
+			if(inexact != m_inexactTimes.cend() && inexact->index == i) {
+				line->m_showTime = Time(inexact->showTime);
+				line->m_hideTime = Time(inexact->hideTime);
+				++inexact;
+			} else {
+				line->m_showTime = Time(inverse(line->m_showTime.toMillis()));
+				line->m_hideTime = Time(inverse(line->m_hideTime.toMillis()));
+			}
+		}
+
+		emit m_subtitle->linesTimesChanged(firstIndex, lastIndex);
+	}
+}
+
+size_t
+TransformTimesAction::memoryUsage() const
+{
+	return sizeof(*this) + m_inexactTimes.size() * sizeof(LineTimes);
+}
+
+
 // *** SwapLinesTextsAction
 SwapLinesTextsAction::SwapLinesTextsAction(Subtitle *subtitle, const RangeList &ranges) :
 	SubtitleAction(subtitle, UndoStack::Both, i18n("Swap Texts")),
@@ -292,9 +458,9 @@ SwapLinesTextsAction::redo()
 {
 	for(SubtitleIterator it(*m_subtitle, m_ranges); it.current(); ++it) {
 		SubtitleLine *line = it.current();
-		RichDocument *tmp = line->m_primaryDoc;
-		line->m_primaryDoc = line->m_secondaryDoc;
-		line->m_secondaryDoc = tmp;
+		qSwap(line->m_primaryDoc, line->m_secondaryDoc);
+		qSwap(line->m_primaryText, line->m_secondaryText);
+		qSwap(line->m_primaryMetrics, line->m_secondaryMetrics);
 		emit line->primaryTextChanged();
 		emit line->secondaryTextChanged();
 	}
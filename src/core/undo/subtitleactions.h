@@ -16,6 +16,7 @@
 
 #include <QString>
 #include <QList>
+#include <QVector>
 
 QT_FORWARD_DECLARE_CLASS(QTextEdit)
 
@@ -29,17 +30,23 @@ public:
 
 	inline void setLineSubtitle(SubtitleLine *line)
 	{
-		line->m_primaryDoc->setStylesheet(m_subtitle->stylesheet());
-		line->m_secondaryDoc->setStylesheet(m_subtitle->stylesheet());
+		if(line->m_primaryDoc)
+			line->m_primaryDoc->setStylesheet(m_subtitle->stylesheet());
+		if(line->m_secondaryDoc)
+			line->m_secondaryDoc->setStylesheet(m_subtitle->stylesheet());
 		line->m_subtitle = m_subtitle;
 	}
 
 	inline void clearLineSubtitle(SubtitleLine *line)
 	{
 		line->m_subtitle = nullptr;
-		line->m_primaryDoc->setStylesheet(nullptr);
-		line->m_secondaryDoc->setStylesheet(nullptr);
+		if(line->m_primaryDoc)
+			line->m_primaryDoc->setStylesheet(nullptr);
+		if(line->m_secondaryDoc)
+			line->m_secondaryDoc->setStylesheet(nullptr);
 	}
+
+	inline void compactLineTexts(SubtitleLine *line) { line->compactTexts(); }
 };
 
 class SetFramesPerSecondAction : public SubtitleAction
@@ -69,6 +76,7 @@ public:
 protected:
 	void redo() override;
 	void undo() override;
+	size_t memoryUsage() const override;
 
 private:
 	int m_insertIndex;
@@ -88,6 +96,9 @@ public:
 protected:
 	void redo() override;
 	void undo() override;
+	size_t memoryUsage() const override;
+	void compact() override;
+	void release() override;
 
 private:
 	int m_firstIndex;
@@ -113,6 +124,67 @@ private:
 	int m_toIndex;
 };
 
+class PermuteLinesAction : public SubtitleAction
+{
+public:
+	/**
+	 * @brief Reorders lines starting at @p firstIndex
+	 * @param permutation line at @p firstIndex + i is moved from @p firstIndex + permutation[i]
+	 */
+	PermuteLinesAction(Subtitle *subtitle, int firstIndex, const QVector<int> &permutation);
+	virtual ~PermuteLinesAction();
+
+	inline int id() const override { return UndoAction::PermuteLines; }
+
+protected:
+	void redo() override;
+	void undo() override;
+	size_t memoryUsage() const override;
+
+private:
+	void permute(bool inverse);
+
+private:
+	int m_firstIndex;
+	const QVector<int> m_permutation;
+};
+
+class TransformTimesAction : public SubtitleAction
+{
+public:
+	/**
+	 * @brief Sets show and hide times of lines in @p ranges to time * @p scaleFactor + @p shiftMseconds
+	 *
+	 * Undo applies inverse transformation, @p scaleFactor must be positive. Original times are kept
+	 * only for lines where inverse transformation doesn't give them back exactly.
+	 */
+	TransformTimesAction(Subtitle *subtitle, const RangeList &ranges, double shiftMseconds, double scaleFactor);
+	virtual ~TransformTimesAction();
+
+	inline int id() const override { return UndoAction::TransformTimes; }
+
+protected:
+	void redo() override;
+	void undo() override;
+	size_t memoryUsage() const override;
+
+private:
+	inline double transformed(double millis) const { return millis * m_scaleFactor + m_shiftMseconds; }
+	inline double inverse(double millis) const { return (millis - m_shiftMseconds) / m_scaleFactor; }
+
+private:
+	struct LineTimes {
+		int index;
+		double showTime;
+		double hideTime;
+	};
+
+	const RangeList m_ranges;
+	const double m_shiftMseconds;
+	const double m_scaleFactor;
+	QVector<LineTimes> m_inexactTimes;
+};
+
 class SwapLinesTextsAction : public SubtitleAction
 {
 public:
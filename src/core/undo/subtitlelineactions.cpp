@@ -23,82 +23,122 @@ SubtitleLineAction::~SubtitleLineAction()
 {}
 
 
-// *** SetLinePrimaryTextAction
-SetLinePrimaryTextAction::SetLinePrimaryTextAction(SubtitleLine *line, RichDocument *primaryDoc)
-	: SubtitleLineAction(line, UndoStack::Primary, i18n("Set Line Text")),
-	  m_primaryDoc(primaryDoc),
-	  m_primaryDocState(primaryDoc->availableUndoSteps())
-{}
+// *** LineTextAction
+LineTextAction::LineTextAction(SubtitleLine *line, bool primary, const RichString &before, const RichString &after)
+	: SubtitleLineAction(line, primary ? UndoStack::Primary : UndoStack::Secondary, primary ? i18n("Set Line Text") : i18n("Set Line Secondary Text")),
+	  m_primary(primary),
+	  m_applied(true)
+{
+	const int prefix = before.commonPrefixLength(after);
+	const int suffix = qMin(before.commonSuffixLength(after), qMin(before.length(), after.length()) - prefix);
+	m_position = prefix;
+	m_removed = before.mid(prefix, before.length() - prefix - suffix);
+	m_inserted = after.mid(prefix, after.length() - prefix - suffix);
+}
 
-SetLinePrimaryTextAction::~SetLinePrimaryTextAction()
+LineTextAction::~LineTextAction()
 {}
 
 bool
-SetLinePrimaryTextAction::mergeWith(const QUndoCommand *command)
+LineTextAction::mergeWith(const QUndoCommand *command)
 {
-	const SetLinePrimaryTextAction *cur = static_cast<const SetLinePrimaryTextAction *>(command);
-	return cur->m_primaryDoc == m_primaryDoc && cur->m_primaryDocState == m_primaryDocState;
+	const LineTextAction *cur = static_cast<const LineTextAction *>(command);
+	if(cur->m_line != m_line || cur->m_primary != m_primary)
+		return false;
+
+	// merge consecutive typing
+	if(m_removed.isEmpty() && cur->m_removed.isEmpty() && cur->m_position == m_position + m_inserted.length()) {
+		m_inserted.append(cur->m_inserted);
+		return true;
+	}
+
+	// merge consecutive deleting and backspacing
+	if(m_inserted.isEmpty() && cur->m_inserted.isEmpty()) {
+		if(cur->m_position == m_position) {
+			m_removed.append(cur->m_removed);
+			return true;
+		}
+		if(cur->m_position + cur->m_removed.length() == m_position) {
+			m_removed.prepend(cur->m_removed);
+			m_position = cur->m_position;
+			return true;
+		}
+	}
+
+	return false;
 }
 
-void
-SetLinePrimaryTextAction::undo()
+size_t
+LineTextAction::memoryUsage() const
 {
-	const bool prev = m_line->ignoreDocChanges(true);
-	while(m_primaryDoc->isUndoAvailable() && m_primaryDoc->availableUndoSteps() >= m_primaryDocState)
-		m_primaryDoc->undo();
-	m_line->ignoreDocChanges(prev);
-	emit m_line->primaryTextChanged();
+	return sizeof(*this) + m_removed.memoryUsage() + m_inserted.memoryUsage() - 2 * sizeof(RichString);
 }
 
 void
-SetLinePrimaryTextAction::redo()
+LineTextAction::release()
 {
-	const bool prev = m_line->ignoreDocChanges(true);
-	while(m_primaryDoc->isRedoAvailable() && m_primaryDoc->availableUndoSteps() < m_primaryDocState)
-		m_primaryDoc->redo();
-	m_line->ignoreDocChanges(prev);
-	emit m_line->primaryTextChanged();
+	m_removed.clear();
+	m_inserted.clear();
 }
 
+void
+LineTextAction::replaceText(const RichString &removed, const RichString &inserted)
+{
+	RichString text = m_line->text(m_primary);
+	Q_ASSERT(text.mid(m_position, removed.length()) == removed);
+	text.replace(m_position, removed.length(), inserted);
 
-// *** SetLineSecondaryTextAction
-SetLineSecondaryTextAction::SetLineSecondaryTextAction(SubtitleLine *line, RichDocument *secondaryDoc)
-	: SubtitleLineAction(line, UndoStack::Secondary, i18n("Set Line Secondary Text")),
-	  m_secondaryDoc(secondaryDoc),
-	  m_secondaryDocState(secondaryDoc->availableUndoSteps())
-{}
-
-SetLineSecondaryTextAction::~SetLineSecondaryTextAction()
-{}
+	const bool prev = m_line->ignoreDocChanges(true);
+	if(RichDocument *doc = m_primary ? m_line->m_primaryDoc : m_line->m_secondaryDoc) {
+		doc->setRichText(text, true);
+		doc->undoableCursor()->setPosition(m_position + inserted.length());
+	} else {
+		m_line->storeText(m_primary, text);
+		(m_primary ? m_line->m_primaryMetrics : m_line->m_secondaryMetrics).valid = false;
+	}
+	m_line->ignoreDocChanges(prev);
 
-bool
-SetLineSecondaryTextAction::mergeWith(const QUndoCommand *command)
-{
-	const SetLineSecondaryTextAction *cur = static_cast<const SetLineSecondaryTextAction *>(command);
-	return cur->m_secondaryDoc == m_secondaryDoc && cur->m_secondaryDocState == m_secondaryDocState;
+	if(m_primary)
+		emit m_line->primaryTextChanged();
+	else
+		emit m_line->secondaryTextChanged();
 }
 
 void
-SetLineSecondaryTextAction::undo()
+LineTextAction::undo()
 {
-	const bool prev = m_line->ignoreDocChanges(true);
-	while(m_secondaryDoc->isUndoAvailable() && m_secondaryDoc->availableUndoSteps() >= m_secondaryDocState)
-		m_secondaryDoc->undo();
-	m_line->ignoreDocChanges(prev);
-	emit m_line->secondaryTextChanged();
+	replaceText(m_inserted, m_removed);
+	m_applied = false;
 }
 
 void
-SetLineSecondaryTextAction::redo()
+LineTextAction::redo()
 {
-	const bool prev = m_line->ignoreDocChanges(true);
-	while(m_secondaryDoc->isRedoAvailable() && m_secondaryDoc->availableUndoSteps() < m_secondaryDocState)
-		m_secondaryDoc->redo();
-	m_line->ignoreDocChanges(prev);
-	emit m_line->secondaryTextChanged();
+	// text was already changed when action was created
+	if(!m_applied)
+		replaceText(m_removed, m_inserted);
+	m_applied = true;
 }
 
 
+// *** SetLinePrimaryTextAction
+SetLinePrimaryTextAction::SetLinePrimaryTextAction(SubtitleLine *line, const RichString &before, const RichString &after)
+	: LineTextAction(line, true, before, after)
+{}
+
+SetLinePrimaryTextAction::~SetLinePrimaryTextAction()
+{}
+
+
+// *** SetLineSecondaryTextAction
+SetLineSecondaryTextAction::SetLineSecondaryTextAction(SubtitleLine *line, const RichString &before, const RichString &after)
+	: LineTextAction(line, false, before, after)
+{}
+
+SetLineSecondaryTextAction::~SetLineSecondaryTextAction()
+{}
+
+
 
 // *** SetLineShowTimeAction
 SetLineShowTimeAction::SetLineShowTimeAction(SubtitleLine *line, const Time &showTime)
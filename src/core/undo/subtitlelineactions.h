@@ -33,44 +33,53 @@ protected:
 	}
 };
 
-class SetLinePrimaryTextAction : public SubtitleLineAction
+/**
+ * @brief Base of line text actions, keeps only the changed part of text
+ *
+ * Action is created after document has already changed, first redo() does nothing.
+ */
+class LineTextAction : public SubtitleLineAction
 {
-	friend class SetLineTextsAction;
-
 public:
-	SetLinePrimaryTextAction(SubtitleLine *line, RichDocument *primaryDoc);
-	virtual ~SetLinePrimaryTextAction();
+	LineTextAction(SubtitleLine *line, bool primary, const RichString &before, const RichString &after);
+	virtual ~LineTextAction();
 
-	inline int id() const override { return UndoAction::SetLinePrimaryText; }
 	bool mergeWith(const QUndoCommand *command) override;
 
+	size_t memoryUsage() const override;
+	void release() override;
+
 protected:
 	void undo() override;
 	void redo() override;
 
 private:
-	RichDocument *m_primaryDoc;
-	int m_primaryDocState = -1;
+	void replaceText(const RichString &removed, const RichString &inserted);
+
+private:
+	const bool m_primary;
+	bool m_applied;
+	int m_position;
+	RichString m_removed;
+	RichString m_inserted;
 };
 
-class SetLineSecondaryTextAction : public SubtitleLineAction
+class SetLinePrimaryTextAction : public LineTextAction
 {
-	friend class SetLineTextsAction;
+public:
+	SetLinePrimaryTextAction(SubtitleLine *line, const RichString &before, const RichString &after);
+	virtual ~SetLinePrimaryTextAction();
 
+	inline int id() const override { return UndoAction::SetLinePrimaryText; }
+};
+
+class SetLineSecondaryTextAction : public LineTextAction
+{
 public:
-	SetLineSecondaryTextAction(SubtitleLine *line, RichDocument *secondaryDoc);
+	SetLineSecondaryTextAction(SubtitleLine *line, const RichString &before, const RichString &after);
 	virtual ~SetLineSecondaryTextAction();
 
 	inline int id() const override { return UndoAction::SetLineSecondaryText; }
-	bool mergeWith(const QUndoCommand *command) override;
-
-protected:
-	void undo() override;
-	void redo() override;
-
-private:
-	RichDocument *m_secondaryDoc;
-	int m_secondaryDocState = -1;
 };
 
 class SetLineShowTimeAction : public SubtitleLineAction
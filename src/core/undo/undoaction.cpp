@@ -25,3 +25,19 @@ UndoAction::undo()
 {
 	redo();
 }
+
+size_t
+UndoAction::memoryUsage() const
+{
+	return sizeof(UndoAction);
+}
+
+void
+UndoAction::compact()
+{
+}
+
+void
+UndoAction::release()
+{
+}
@@ -19,6 +19,7 @@ class Subtitle;
 class UndoAction : public QUndoCommand
 {
 	friend class UndoStack;
+	friend class UndoMemoryTracker;
 
 public:
 	enum {
@@ -27,6 +28,8 @@ public:
 		InsertLines,
 		RemoveLines,
 		MoveLine,
+		PermuteLines,
+		TransformTimes,
 		SwapLinesTexts,
 		ChangeStylesheet,
 
@@ -48,6 +51,19 @@ public:
 	void undo() override;
 
 protected:
+	/**
+	 * @brief Approximate memory held by the action to be able to undo/redo it
+	 */
+	virtual size_t memoryUsage() const;
+	/**
+	 * @brief Reduces memory held by the action, it still can be undone
+	 */
+	virtual void compact();
+	/**
+	 * @brief Frees memory needed to undo the action, it must not be undone afterwards
+	 */
+	virtual void release();
+
 	const UndoStack::DirtyMode m_dirtyMode;
 	QExplicitlySharedDataPointer<Subtitle> m_subtitle;
 };
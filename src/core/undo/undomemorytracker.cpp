@@ -0,0 +1,108 @@
+/*
+    SPDX-FileCopyrightText: 2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "undomemorytracker.h"
+
+#include "core/undo/undoaction.h"
+
+#include <QUndoStack>
+
+using namespace SubtitleComposer;
+
+UndoMemoryTracker::UndoMemoryTracker(const QUndoStack *stack)
+	: m_stack(stack),
+	  m_lastIndex(0),
+	  m_compactIndex(0),
+	  m_undoFloor(0),
+	  m_memoryUsage(0)
+{
+}
+
+void
+UndoMemoryTracker::clear()
+{
+	m_lastIndex = 0;
+	m_compactIndex = 0;
+	m_undoFloor = 0;
+	m_memoryStack.clear();
+	m_memoryUsage = 0;
+}
+
+void
+UndoMemoryTracker::indexChanged(int idx)
+{
+	const int n = m_stack->count();
+	if(!n)
+		m_undoFloor = 0;
+
+	// push discards commands that could be redone and can merge into the top one,
+	// undo/redo move lines and texts in and out of commands
+	for(int i = n; i < m_memoryStack.size(); i++)
+		m_memoryUsage -= m_memoryStack.at(i);
+	m_memoryStack.resize(n);
+	for(int i = qMax(0, qMin(m_lastIndex, idx) - 1), last = qMin(n, qMax(m_lastIndex, idx)); i < last; i++)
+		updateMemoryUsage(i);
+
+	m_lastIndex = idx;
+	m_compactIndex = qMin(m_compactIndex, idx);
+}
+
+void
+UndoMemoryTracker::updateMemoryUsage(int idx)
+{
+	const size_t usage = commandMemoryUsage(m_stack->command(idx));
+	m_memoryUsage = m_memoryUsage - m_memoryStack.at(idx) + usage;
+	m_memoryStack[idx] = usage;
+}
+
+void
+UndoMemoryTracker::applyLimit(size_t limit)
+{
+	if(!limit || m_memoryUsage <= limit)
+		return;
+
+	const int idx = m_stack->index();
+
+	// oldest commands are compacted first, they can still be undone
+	for(m_compactIndex = qMax(m_compactIndex, m_undoFloor); m_compactIndex < idx && m_memoryUsage > limit; m_compactIndex++) {
+		compactCommand(const_cast<QUndoCommand *>(m_stack->command(m_compactIndex)));
+		updateMemoryUsage(m_compactIndex);
+	}
+
+	// then dropped, the most recent command can always be undone
+	for(; m_undoFloor < idx - 1 && m_memoryUsage > limit; m_undoFloor++) {
+		releaseCommand(const_cast<QUndoCommand *>(m_stack->command(m_undoFloor)));
+		updateMemoryUsage(m_undoFloor);
+	}
+}
+
+size_t
+UndoMemoryTracker::commandMemoryUsage(const QUndoCommand *cmd)
+{
+	const UndoAction *action = dynamic_cast<const UndoAction *>(cmd);
+	size_t usage = action ? action->memoryUsage() : sizeof(QUndoCommand);
+	for(int i = 0, n = cmd->childCount(); i < n; i++)
+		usage += commandMemoryUsage(cmd->child(i));
+	return usage;
+}
+
+void
+UndoMemoryTracker::compactCommand(QUndoCommand *cmd)
+{
+	if(UndoAction *action = dynamic_cast<UndoAction *>(cmd))
+		action->compact();
+	for(int i = 0, n = cmd->childCount(); i < n; i++)
+		compactCommand(const_cast<QUndoCommand *>(cmd->child(i)));
+}
+
+void
+UndoMemoryTracker::releaseCommand(QUndoCommand *cmd)
+{
+	if(UndoAction *action = dynamic_cast<UndoAction *>(cmd))
+		action->release();
+	for(int i = 0, n = cmd->childCount(); i < n; i++)
+		releaseCommand(const_cast<QUndoCommand *>(cmd->child(i)));
+}
@@ -0,0 +1,68 @@
+/*
+    SPDX-FileCopyrightText: 2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef UNDOMEMORYTRACKER_H
+#define UNDOMEMORYTRACKER_H
+
+#include <QVector>
+
+QT_FORWARD_DECLARE_CLASS(QUndoCommand)
+QT_FORWARD_DECLARE_CLASS(QUndoStack)
+
+namespace SubtitleComposer {
+
+/**
+ * @brief Accounts memory held by commands of an undo stack and keeps it within a limit
+ *
+ * Oldest commands are compacted first, if that is not enough they are released and
+ * can't be undone anymore - they end up below the floor.
+ */
+class UndoMemoryTracker
+{
+public:
+	explicit UndoMemoryTracker(const QUndoStack *stack);
+
+	void clear();
+
+	/**
+	 * @brief Updates accounting of commands affected by stack index change, must be called on every change
+	 */
+	void indexChanged(int idx);
+	/**
+	 * @brief Compacts and releases oldest commands until usage is within @p limit bytes
+	 * @param limit memory limit in bytes, zero means unlimited
+	 */
+	void applyLimit(size_t limit);
+
+	/**
+	 * @brief Approximate memory held by all commands in the stack
+	 */
+	inline size_t memoryUsage() const { return m_memoryUsage; }
+	/**
+	 * @brief Index of the oldest command that can be undone
+	 */
+	inline int floor() const { return m_undoFloor; }
+
+	static size_t commandMemoryUsage(const QUndoCommand *cmd);
+
+private:
+	void updateMemoryUsage(int idx);
+
+	static void compactCommand(QUndoCommand *cmd);
+	static void releaseCommand(QUndoCommand *cmd);
+
+private:
+	const QUndoStack *m_stack;
+	int m_lastIndex;
+	int m_compactIndex;
+	int m_undoFloor;
+	QVector<size_t> m_memoryStack;
+	size_t m_memoryUsage;
+};
+
+}
+
+#endif // UNDOMEMORYTRACKER_H
@@ -13,6 +13,7 @@
 #include "core/undo/undoaction.h"
 #include "gui/treeview/lineswidget.h"
 #include "gui/treeview/linesmodel.h"
+#include "scconfig.h"
 
 using namespace SubtitleComposer;
 
@@ -20,7 +21,8 @@ UndoStack::UndoStack(QObject *parent)
 	: QUndoStack(parent),
 	  m_level(0),
 	  m_undoAction(QUndoStack::createUndoAction(UserActionManager::instance())),
-	  m_redoAction(QUndoStack::createRedoAction(UserActionManager::instance()))
+	  m_redoAction(QUndoStack::createRedoAction(UserActionManager::instance())),
+	  m_memory(this)
 {
 	m_selectionStack.push(Selection(app()->linesWidget()->selectionModel()));
 
@@ -28,11 +30,16 @@ UndoStack::UndoStack(QObject *parent)
 	connect(this, &UndoStack::redoTextChanged, redoAction(), &QAction::setToolTip);
 	connect(this, &UndoStack::indexChanged, parent, [](){ if(Subtitle *s = appSubtitle()) s->updateState(); });
 	connect(this, &UndoStack::cleanChanged, parent, [](){ if(Subtitle *s = appSubtitle()) s->updateState(); });
+	// QUndoStack enables undo action without knowing about the memory limit floor
+	connect(this, &UndoStack::canUndoChanged, m_undoAction, [this](){ m_undoAction->setEnabled(canUndo()); });
+	connect(this, &UndoStack::indexChanged, this, &UndoStack::onIndexChanged);
+	connect(SCConfig::self(), &KCoreConfigSkeleton::configChanged, this, &UndoStack::applyMemoryLimit);
 }
 
 UndoStack::~UndoStack()
 {
-
+	// QUndoStack destructor clears commands and emits signals after our members are gone
+	disconnect(this, nullptr, nullptr, nullptr);
 }
 
 void
@@ -40,6 +47,7 @@ UndoStack::clear()
 {
 	m_selectionStack.clear();
 	m_selectionStack.push(Selection(app()->linesWidget()->selectionModel()));
+	m_memory.clear();
 	QUndoStack::clear();
 }
 
@@ -141,6 +149,9 @@ UndoStack::endMacro(DirtyMode dirtyOverride)
 void
 UndoStack::undo()
 {
+	if(!canUndo())
+		return;
+
 	QUndoStack::undo();
 
 	const Selection &sel = m_selectionStack.at(index() + 1);
@@ -156,6 +167,24 @@ UndoStack::redo()
 	restoreSelection(sel.postCurrentRow, sel.postSelection);
 }
 
+void
+UndoStack::onIndexChanged(int idx)
+{
+	m_memory.indexChanged(idx);
+
+	// undo action is connected to QUndoStack::undo() and has to be kept in sync with floor on every change
+	m_undoAction->setEnabled(canUndo());
+
+	applyMemoryLimit();
+}
+
+void
+UndoStack::applyMemoryLimit()
+{
+	m_memory.applyLimit(size_t(SCConfig::undoMemoryLimit()) << 20);
+	m_undoAction->setEnabled(canUndo());
+}
+
 
 UndoStack::Selection::Selection()
 	: preCurrentRow(-1)
@@ -9,6 +9,8 @@
 
 #include <QUndoStack>
 
+#include "core/undo/undomemorytracker.h"
+
 #include <QStack>
 
 QT_FORWARD_DECLARE_CLASS(QItemSelectionModel)
@@ -47,7 +49,10 @@ public:
 	void beginMacro(const QString &text);
 	void endMacro(DirtyMode dirtyOverride = Invalid);
 
-	using QUndoStack::canUndo;
+	/**
+	 * @brief Commands below memory limit floor can't be undone
+	 */
+	inline bool canUndo() const { return QUndoStack::canUndo() && index() > m_memory.floor(); }
 	using QUndoStack::canRedo;
 	using QUndoStack::undoText;
 	using QUndoStack::redoText;
@@ -70,6 +75,11 @@ public:
 	inline DirtyMode dirtyMode(int index) const { return m_dirtyStack.at(index); }
 	using QUndoStack::command;
 
+	/**
+	 * @brief Approximate memory held by all commands in the stack
+	 */
+	inline size_t memoryUsage() const { return m_memory.memoryUsage(); }
+
 public slots:
 	void undo();
 	void redo();
@@ -78,12 +88,17 @@ private:
 	void levelIncrease(int idx);
 	void levelDecrease(int idx);
 
+	void onIndexChanged(int idx);
+	void applyMemoryLimit();
+
 private:
 	int m_level;
 	QStack<Selection> m_selectionStack;
 	QStack<DirtyMode> m_dirtyStack;
 	QAction *m_undoAction;
 	QAction *m_redoAction;
+
+	UndoMemoryTracker m_memory;
 };
 
 }
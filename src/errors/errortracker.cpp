@@ -10,12 +10,20 @@
 #include "core/richtext/richdocument.h"
 #include "core/subtitleline.h"
 
+#include <QThread>
+
+#include <vector>
+
 using namespace SubtitleComposer;
 
+// smallest batch worth giving to another thread
+static const int MinChecksPerThread = 256;
+
 ErrorTracker::ErrorTracker(QObject *parent)
 	: QObject(parent),
 	  m_subtitle(nullptr),
-	  m_autoClearFixed(SCConfig::autoClearFixed())
+	  m_autoClearFixed(SCConfig::autoClearFixed()),
+	  m_batching(false)
 {
 	connect(SCConfig::self(), &SCConfig::configChanged, this, &ErrorTracker::onConfigChanged);
 }
@@ -46,18 +54,81 @@ ErrorTracker::connectSlots()
 	connect(m_subtitle.constData(), &Subtitle::lineSecondaryTextChanged, this, &ErrorTracker::onLineSecondaryTextChanged);
 	connect(m_subtitle.constData(), &Subtitle::lineShowTimeChanged, this, &ErrorTracker::onLineTimesChanged);
 	connect(m_subtitle.constData(), &Subtitle::lineHideTimeChanged, this, &ErrorTracker::onLineTimesChanged);
+	connect(m_subtitle.constData(), &Subtitle::linesTimesChanged, this, &ErrorTracker::onLinesTimesChanged);
+	connect(m_subtitle.constData(), &Subtitle::linesAboutToBeRemoved, this, &ErrorTracker::onLinesAboutToBeRemoved);
+	connect(m_subtitle.constData(), &Subtitle::compositeActionStart, this, &ErrorTracker::onCompositeActionStart);
+	connect(m_subtitle.constData(), &Subtitle::compositeActionEnd, this, &ErrorTracker::onCompositeActionEnd);
 }
 
 void
 ErrorTracker::disconnectSlots()
 {
 	disconnect(m_subtitle.constData(), nullptr, this, nullptr);
+	m_batching = false;
+	m_dirtyLines.clear();
+}
+
+void
+ErrorTracker::updateLineErrors(SubtitleLine *line, int errorFlags)
+{
+	if(!m_batching)
+		line->check(errorFlags);
+	else if(errorFlags)
+		m_dirtyLines[line] |= errorFlags;
 }
 
 void
-ErrorTracker::updateLineErrors(SubtitleLine *line, int errorFlags) const
+ErrorTracker::checkDirtyLines()
 {
-	line->check(errorFlags);
+	struct Check {
+		SubtitleLine *line;
+		int errorFlags;
+		SubtitleLine::TextSnapshot text;
+		int textErrorFlags;
+	};
+
+	// documents can only be read here, text checks work on plain text snapshots
+	std::vector<Check> checks;
+	checks.reserve(m_dirtyLines.size());
+	for(auto it = m_dirtyLines.cbegin(); it != m_dirtyLines.cend(); ++it) {
+		SubtitleLine *line = it.key();
+		const int errorFlags = it.value() & line->errorFlags();
+		if(!errorFlags)
+			continue;
+		const int textErrorFlags = errorFlags & SubtitleLine::TextErrors;
+		checks.push_back(Check{line, errorFlags, line->textSnapshot(textErrorFlags), 0});
+	}
+	m_dirtyLines.clear();
+
+	Check *data = checks.data();
+	const auto checkTexts = [data](int from, int to){
+		for(Check *c = data + from, *end = data + to; c != end; c++)
+			c->textErrorFlags = SubtitleLine::checkText(c->text, c->errorFlags & SubtitleLine::TextErrors);
+	};
+
+	const int count = int(checks.size());
+	const int threadCount = qBound(1, count / MinChecksPerThread, QThread::idealThreadCount());
+	const int chunk = (count + threadCount - 1) / threadCount;
+	QVector<QThread *> threads;
+	for(int t = 1; t < threadCount; t++) {
+		const int from = t * chunk;
+		const int to = qMin(count, from + chunk);
+		QThread *thread = QThread::create([&checkTexts, from, to](){ checkTexts(from, to); });
+		thread->start();
+		threads.push_back(thread);
+	}
+	checkTexts(0, qMin(count, chunk));
+	for(QThread *thread: qAsConst(threads)) {
+		thread->wait();
+		delete thread;
+	}
+
+	for(const Check &c: checks) {
+		const int otherErrorFlags = c.errorFlags & ~SubtitleLine::TextErrors;
+		int lineErrorFlags = otherErrorFlags ? c.line->check(otherErrorFlags, false) : c.line->errorFlags();
+		lineErrorFlags = (lineErrorFlags & ~(c.errorFlags & SubtitleLine::TextErrors)) | c.textErrorFlags;
+		c.line->setErrorFlags(lineErrorFlags);
+	}
 }
 
 void
@@ -82,6 +153,42 @@ ErrorTracker::onLineTimesChanged(SubtitleLine *line)
 		updateLineErrors(prevLine, prevLine->errorFlags() & SubtitleLine::OverlapsWithNext);
 }
 
+void
+ErrorTracker::onLinesTimesChanged(int firstIndex, int lastIndex)
+{
+	for(int i = firstIndex; i <= lastIndex; i++) {
+		SubtitleLine *line = const_cast<SubtitleLine *>(m_subtitle->at(i));
+		updateLineErrors(line, line->errorFlags() & SubtitleLine::TimesErrors);
+	}
+
+	if(firstIndex > 0) {
+		SubtitleLine *prevLine = const_cast<SubtitleLine *>(m_subtitle->at(firstIndex - 1));
+		updateLineErrors(prevLine, prevLine->errorFlags() & SubtitleLine::OverlapsWithNext);
+	}
+}
+
+void
+ErrorTracker::onLinesAboutToBeRemoved(int firstIndex, int lastIndex)
+{
+	if(m_dirtyLines.isEmpty())
+		return;
+	for(int i = firstIndex; i <= lastIndex; i++)
+		m_dirtyLines.remove(const_cast<SubtitleLine *>(m_subtitle->at(i)));
+}
+
+void
+ErrorTracker::onCompositeActionStart()
+{
+	m_batching = true;
+}
+
+void
+ErrorTracker::onCompositeActionEnd()
+{
+	m_batching = false;
+	checkDirtyLines();
+}
+
 void
 ErrorTracker::onConfigChanged()
 {
@@ -10,6 +10,8 @@
 
 #include "core/subtitle.h"
 
+#include <QHash>
+
 namespace SubtitleComposer {
 class SubtitleLine;
 
@@ -30,18 +32,28 @@ private:
 	void connectSlots();
 	void disconnectSlots();
 
-	void updateLineErrors(SubtitleLine *line, int errorFlags) const;
+	void updateLineErrors(SubtitleLine *line, int errorFlags);
+	void checkDirtyLines();
 
 private slots:
 	void onLinePrimaryTextChanged(SubtitleLine *line);
 	void onLineSecondaryTextChanged(SubtitleLine *line);
 	void onLineTimesChanged(SubtitleLine *line);
+	void onLinesTimesChanged(int firstIndex, int lastIndex);
+	void onLinesAboutToBeRemoved(int firstIndex, int lastIndex);
+
+	void onCompositeActionStart();
+	void onCompositeActionEnd();
 
 	void onConfigChanged();
 
 private:
 	QExplicitlySharedDataPointer<const Subtitle> m_subtitle;
 	bool m_autoClearFixed;
+
+	// while composite action is open, changed lines are collected and checked once it ends
+	bool m_batching;
+	QHash<SubtitleLine *, int> m_dirtyLines;
 };
 }
 #endif
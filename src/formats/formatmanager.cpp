@@ -42,6 +42,10 @@
 #include <QFileInfo>
 #include <QSaveFile>
 #include <QTextCodec>
+#include <QTextDecoder>
+#include <QTextEncoder>
+#include <QThread>
+#include <QVector>
 
 #include <QUrl>
 
@@ -49,6 +53,9 @@
 #	include <unicode/ucsdet.h>
 #endif
 
+#include <algorithm>
+#include <limits>
+
 using namespace SubtitleComposer;
 
 FormatManager &
@@ -169,6 +176,57 @@ FormatManager::readBinary(Subtitle &subtitle, const QUrl &url, bool primary,
 	return ERROR;
 }
 
+/**
+ * @brief Append @p chunk to @p text converting CR and CRLF line endings to LF
+ * @param pendingCR set when chunk ended with CR so LF at start of the next chunk gets skipped
+ */
+static void
+appendNormalizedNewlines(QString &text, const QString &chunk, bool &pendingCR)
+{
+	if(chunk.isEmpty())
+		return;
+
+	int pos = pendingCR && chunk.at(0) == QChar::LineFeed ? 1 : 0;
+	pendingCR = false;
+	for(;;) {
+		const int cr = chunk.indexOf(QChar::CarriageReturn, pos);
+		if(cr == -1) {
+			text.append(chunk.constData() + pos, chunk.size() - pos);
+			return;
+		}
+		text.append(chunk.constData() + pos, cr - pos);
+		text.append(QChar::LineFeed);
+		pos = cr + 1;
+		if(pos == chunk.size()) {
+			pendingCR = true;
+			return;
+		}
+		if(chunk.at(pos) == QChar::LineFeed)
+			pos++;
+	}
+}
+
+/**
+ * @brief Decode whole file data in chunks, so only the resulting string is held in memory
+ * @param codec when null data is decoded as latin1
+ */
+static QString
+decodeText(const char *data, qint64 size, QTextCodec *codec)
+{
+	const qint64 chunkSize = 1024 * 1024;
+
+	QScopedPointer<QTextDecoder> decoder(codec ? codec->makeDecoder() : nullptr);
+	QString text;
+	text.reserve(int(qMin<qint64>(size, std::numeric_limits<int>::max() / 2)));
+	bool pendingCR = false;
+	for(qint64 off = 0; off < size; off += chunkSize) {
+		const int len = int(qMin(chunkSize, size - off));
+		const QString chunk = decoder ? decoder->toUnicode(data + off, len) : QString::fromLatin1(data + off, len);
+		appendNormalizedNewlines(text, chunk, pendingCR);
+	}
+	return text;
+}
+
 FormatManager::Status
 FormatManager::readText(Subtitle &subtitle, const QUrl &url, bool primary,
 						QTextCodec **codec, QString *formatName) const
@@ -176,49 +234,69 @@ FormatManager::readText(Subtitle &subtitle, const QUrl &url, bool primary,
 	QFile file(url.toLocalFile());
 	if(!file.open(QIODevice::ReadOnly))
 		return ERROR;
-	// WARNING: only 1MB of text subtitle is being read here
-	QByteArray byteData = file.read(1024 * 1024);
-	file.close();
+
+	// map the file when possible, data gets decoded straight from the mapping
+	QByteArray fileData;
+	const qint64 fileSize = file.size();
+	const char *byteData = fileSize > 0 ? reinterpret_cast<const char *>(file.map(0, fileSize)) : nullptr;
+	qint64 byteSize = fileSize;
+	if(!byteData) {
+		fileData = file.readAll();
+		byteData = fileData.constData();
+		byteSize = fileData.size();
+	}
 
 	QString stringData;
 	if(!codec) {
 		// don't care about text nor text encoding
-		stringData = QString::fromLatin1(byteData);
+		stringData = decodeText(byteData, byteSize, nullptr);
 	} else {
 		if(!*codec) {
-			QTextCodec *c = detectEncoding(byteData);
+			// prefix of the file is enough to detect encoding
+			const int prefixSize = int(qMin<qint64>(byteSize, 256 * 1024));
+			QTextCodec *c = detectEncoding(QByteArray::fromRawData(byteData, prefixSize));
 			if(!c)
 				return CANCEL;
 			*codec = c;
 		}
-		if(*codec)
-			stringData = (*codec)->toUnicode(byteData);
+		stringData = decodeText(byteData, byteSize, *codec);
 	}
 
-	stringData.replace(QLatin1String("\r\n"), QLatin1String("\n"));
-	stringData.replace('\r', '\n');
+	file.close();
 
 	const QString extension = QFileInfo(url.path()).suffix();
 
-	// attempt to parse subtitles based on extension information first
+	// rank formats by probing start of the data, so usually only the right one does the full parse
+	struct Candidate {
+		const InputFormat *format;
+		int score;
+		bool knowsExtension;
+	};
+	const QString prefix = stringData.left(8 * 1024);
+	QVector<Candidate> candidates;
+	QVector<Candidate> fallbacks;
 	for(QMap<QString, InputFormat *>::ConstIterator it = m_inputFormats.begin(), end = m_inputFormats.end(); it != end; ++it) {
-		if(it.value()->knowsExtension(extension)) {
-			if(it.value()->readSubtitle(subtitle, primary, stringData)) {
-				if(formatName)
-					*formatName = it.value()->name();
-				return SUCCESS;
-			}
-		}
+		const int score = it.value()->probe(prefix);
+		const bool knowsExtension = it.value()->knowsExtension(extension);
+		// formats that know the extension are still tried in case probing missed them
+		if(score > 0 || knowsExtension)
+			candidates.push_back(Candidate{it.value(), score, knowsExtension});
+		else
+			fallbacks.push_back(Candidate{it.value(), score, knowsExtension});
 	}
-
-	// attempt to parse subtitles based on content
-	for(QMap<QString, InputFormat *>::ConstIterator it = m_inputFormats.begin(), end = m_inputFormats.end(); it != end; ++it) {
-		if(!it.value()->knowsExtension(extension)) {
-			if(it.value()->readSubtitle(subtitle, primary, stringData)) {
-				if(formatName)
-					*formatName = it.value()->name();
-				return SUCCESS;
-			}
+	std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b){
+		if(a.score != b.score)
+			return a.score > b.score;
+		return a.knowsExtension && !b.knowsExtension;
+	});
+	// probing sees only the prefix and can miss valid variants, everything else is tried last
+	candidates.append(fallbacks);
+
+	for(const Candidate &candidate: qAsConst(candidates)) {
+		if(candidate.format->readSubtitle(subtitle, primary, stringData)) {
+			if(formatName)
+				*formatName = candidate.format->name();
+			return SUCCESS;
 		}
 	}
 
@@ -260,9 +338,8 @@ FormatManager::outputNames() const
 	return m_outputFormats.keys();
 }
 
-bool
-FormatManager::writeSubtitle(const Subtitle &subtitle, bool primary, const QUrl &url,
-							 QTextCodec *codec, const QString &formatName, bool overwrite) const
+const OutputFormat *
+FormatManager::outputForUrl(const QString &formatName, const QUrl &url) const
 {
 	const OutputFormat *format = output(formatName);
 	if(format == nullptr) {
@@ -274,30 +351,117 @@ FormatManager::writeSubtitle(const Subtitle &subtitle, bool primary, const QUrl
 				break;
 			}
 	}
+	return format;
+}
 
-	if(format == nullptr)
-		return false;
+/**
+ * @brief Encode @p data into @p file in chunks, converting line breaks on the fly
+ * @param lineBreak 0 - LF, 1 - CRLF, 2 - CR
+ */
+bool
+FormatManager::writeEncoded(QIODevice *file, const QString &data, QTextCodec *codec, int lineBreak)
+{
+	const int chunkSize = 64 * 1024;
+
+	// BOM is written explicitly below, encoder would write its own on first chunk
+	QScopedPointer<QTextEncoder> encoder(codec->makeEncoder(QTextCodec::IgnoreHeader));
+	if(codec->name().startsWith("UTF-") || codec->name().contains("UCS-")) {
+		const QChar bom(QChar::ByteOrderMark);
+		const QByteArray bytes = encoder->fromUnicode(&bom, 1);
+		if(file->write(bytes) != bytes.size())
+			return false;
+	}
+
+	QString chunk;
+	for(int off = 0, size = data.size(); off < size;) {
+		int len = qMin(chunkSize, size - off);
+		// don't split surrogate pairs between chunks
+		if(off + len < size && data.at(off + len - 1).isHighSurrogate())
+			len--;
+
+		QByteArray bytes;
+		switch(lineBreak) {
+		case 1: // CRLF
+			chunk = QString(data.constData() + off, len).replace(QChar::LineFeed, QLatin1String("\r\n"));
+			bytes = encoder->fromUnicode(chunk);
+			break;
+		case 2: // CR
+			chunk = QString(data.constData() + off, len).replace(QChar::LineFeed, QChar::CarriageReturn);
+			bytes = encoder->fromUnicode(chunk);
+			break;
+		default: // LF
+			bytes = encoder->fromUnicode(data.constData() + off, len);
+			break;
+		}
+		if(file->write(bytes) != bytes.size())
+			return false;
+
+		off += len;
+	}
+
+	return true;
+}
 
-	if(!overwrite && QFile::exists(url.toLocalFile()))
+static bool
+writeSubtitleFile(const OutputFormat *format, const Subtitle &subtitle, bool primary, const QString &fileName,
+				  QTextCodec *codec, int lineBreak, bool overwrite)
+{
+	if(!overwrite && QFile::exists(fileName))
 		return false;
-	QSaveFile file(url.toLocalFile());
+	QSaveFile file(fileName);
 	if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
 		return false;
 
-	QString data = format->writeSubtitle(subtitle, primary);
-	if(codec->name().startsWith("UTF-") || codec->name().contains("UCS-"))
-		data.prepend(QChar::ByteOrderMark);
-	switch(SCConfig::textLineBreak()) {
-	case 1: // CRLF
-		file.write(codec->fromUnicode(data.replace(QChar::LineFeed, QLatin1String("\r\n"))));
-		break;
-	case 2: // CR
-		file.write(codec->fromUnicode(data.replace(QChar::LineFeed, QChar::CarriageReturn)));
-		break;
-	default: // LF
-		file.write(codec->fromUnicode(data));
-		break;
+	if(!FormatManager::writeEncoded(&file, format->writeSubtitle(subtitle, primary), codec, lineBreak)) {
+		file.cancelWriting();
+		return false;
 	}
 
 	return file.commit();
 }
+
+bool
+FormatManager::writeSubtitle(const Subtitle &subtitle, bool primary, const QUrl &url,
+							 QTextCodec *codec, const QString &formatName, bool overwrite) const
+{
+	const OutputFormat *format = outputForUrl(formatName, url);
+	if(format == nullptr)
+		return false;
+
+	return writeSubtitleFile(format, subtitle, primary, url.toLocalFile(), codec, SCConfig::textLineBreak(), overwrite);
+}
+
+/**
+ * @brief Write subtitle in multiple formats at once
+ *
+ * Every job is serialized and written on its own thread, from a snapshot of @p subtitle.
+ * @return true if all jobs succeeded, results of individual jobs are stored in WriteJob::success
+ */
+bool
+FormatManager::writeSubtitles(const Subtitle &subtitle, bool primary, QVector<WriteJob> &jobs,
+							  QTextCodec *codec, bool overwrite) const
+{
+	const QExplicitlySharedDataPointer<const Subtitle> snapshot(subtitle.snapshot());
+	const int lineBreak = SCConfig::textLineBreak();
+
+	QVector<QThread *> threads;
+	for(WriteJob &job: jobs) {
+		job.success = false;
+		const OutputFormat *format = outputForUrl(job.format, job.url);
+		if(format == nullptr)
+			continue;
+		const QString fileName = job.url.toLocalFile();
+		QThread *thread = QThread::create([&job, format, &snapshot, primary, fileName, codec, lineBreak, overwrite](){
+			job.success = writeSubtitleFile(format, *snapshot, primary, fileName, codec, lineBreak, overwrite);
+		});
+		thread->start();
+		threads.push_back(thread);
+	}
+
+	for(QThread *thread: qAsConst(threads)) {
+		thread->wait();
+		delete thread;
+	}
+
+	return std::all_of(jobs.cbegin(), jobs.cend(), [](const WriteJob &job){ return job.success; });
+}
@@ -13,10 +13,12 @@
 #include <QString>
 #include <QStringList>
 #include <QMap>
+#include <QVector>
 
 #include <QUrl>
 #include <KEncodingProber>
 
+QT_FORWARD_DECLARE_CLASS(QIODevice)
 QT_FORWARD_DECLARE_CLASS(QTextCodec)
 
 namespace SubtitleComposer {
@@ -48,6 +50,16 @@ public:
 	bool writeSubtitle(const Subtitle &subtitle, bool primary, const QUrl &url,
 					   QTextCodec *codec, const QString &format, bool overwrite) const;
 
+	struct WriteJob {
+		QUrl url;
+		QString format;
+		bool success = false;
+	};
+	bool writeSubtitles(const Subtitle &subtitle, bool primary, QVector<WriteJob> &jobs,
+						QTextCodec *codec, bool overwrite) const;
+
+	static bool writeEncoded(QIODevice *file, const QString &data, QTextCodec *codec, int lineBreak);
+
 protected:
 	FormatManager();
 	~FormatManager();
@@ -57,6 +69,8 @@ protected:
 	Status readText(Subtitle &subtitle, const QUrl &url, bool primary,
 					QTextCodec **codec, QString *formatName) const;
 
+	const OutputFormat * outputForUrl(const QString &formatName, const QUrl &url) const;
+
 	QMap<QString, InputFormat *> m_inputFormats;
 	QMap<QString, OutputFormat *> m_outputFormats;
 };
@@ -11,6 +11,8 @@
 #include "format.h"
 #include "formatmanager.h"
 
+#include <QRegularExpression>
+
 namespace SubtitleComposer {
 class InputFormat : public Format
 {
@@ -30,12 +32,29 @@ public:
 		return true;
 	}
 
+	/**
+	 * @brief Cheap estimate of how likely is @p prefix (first few KB of the data) in this format
+	 * @return 0 if data doesn't look like this format, higher score means better match
+	 */
+	virtual int probe(const QString &prefix) const { Q_UNUSED(prefix); return 0; }
+
 	virtual bool isBinary() const { return false; }
 	virtual FormatManager::Status readBinary(Subtitle &, const QUrl &) { return FormatManager::ERROR; }
 
 protected:
 	virtual bool parseSubtitles(Subtitle &subtitle, const QString &data) const = 0;
 
+	// score of formats that have unique header, ranks them above formats that count matching lines
+	static const int SignatureScore = 1000;
+
+	static int probeMatches(const QRegularExpression &re, const QString &prefix)
+	{
+		int matches = 0;
+		for(QRegularExpressionMatchIterator it = re.globalMatch(prefix); it.hasNext(); it.next())
+			matches++;
+		return matches;
+	}
+
 	InputFormat(const QString &name, const QStringList &extensions) : Format(name, extensions) {}
 };
 }
@@ -25,6 +25,12 @@ protected:
 		: InputFormat($("MicroDVD"), QStringList() << $("sub") << $("txt"))
 	{}
 
+	int probe(const QString &prefix) const override
+	{
+		staticRE$(reLine, "(?:^|\n)\\{\\d+\\}\\{\\d+\\}", REu);
+		return probeMatches(reLine, prefix);
+	}
+
 	bool parseSubtitles(Subtitle &subtitle, const QString &data) const override
 	{
 		staticRE$(lineRE, "\\{(\\d+)\\}\\{(\\d+)\\}([^\n]+)\n", REu | REi);
@@ -50,6 +56,8 @@ protected:
 		if(!itLine.hasNext())
 			return false;
 
+		SubtitleLineBatch batch(&subtitle);
+
 		do {
 			mLine = itLine.next();
 
@@ -118,10 +126,11 @@ protected:
 			}
 
 			SubtitleLine *l = new SubtitleLine(showTime, hideTime);
-			l->primaryDoc()->setRichText(richText.replace('|', '\n'), true);
-			subtitle.insertLine(l);
+			l->setPrimaryText(richText.replace('|', '\n'));
+			batch.append(l);
 		} while(itLine.hasNext());
 
+		batch.commit();
 		return true;
 	}
 };
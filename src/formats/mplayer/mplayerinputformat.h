@@ -24,6 +24,12 @@ protected:
 		: InputFormat($("MPlayer"), QStringList($("mpl")))
 	{}
 
+	int probe(const QString &prefix) const override
+	{
+		staticRE$(reLine, "(?:^|\n)\\d+,\\d+,0,", REu);
+		return probeMatches(reLine, prefix);
+	}
+
 	bool parseSubtitles(Subtitle &subtitle, const QString &data) const override
 	{
 		staticRE$(lineRE, "(^|\n)(\\d+),(\\d+),0,([^\n]+)[^\n]", REu | REi);
@@ -34,6 +40,8 @@ protected:
 		if(!itLine.hasNext())
 			return false;
 
+		SubtitleLineBatch batch(&subtitle);
+
 		do {
 			const QRegularExpressionMatch mLine = itLine.next();
 			const Time showTime(static_cast<long>((mLine.captured(1).toLong() / fps) * 1000));
@@ -41,10 +49,11 @@ protected:
 			const QString text = mLine.captured(3).replace(QChar('|'), QChar('\n'));
 
 			SubtitleLine *line = new SubtitleLine(showTime, hideTime);
-			line->primaryDoc()->setPlainText(text);
-			subtitle.insertLine(line);
+			line->setPrimaryText(RichString(text));
+			batch.append(line);
 		} while(itLine.hasNext());
 
+		batch.commit();
 		return true;
 	}
 };
@@ -24,6 +24,12 @@ protected:
 		: InputFormat($("MPlayer2"), QStringList($("mpl")))
 	{}
 
+	int probe(const QString &prefix) const override
+	{
+		staticRE$(reLine, "(?:^|\n)\\[\\d+\\]\\[\\d+\\]", REu);
+		return probeMatches(reLine, prefix);
+	}
+
 	bool parseSubtitles(Subtitle &subtitle, const QString &data) const override
 	{
 		staticRE$(lineRE, "\\[(\\d+)\\]\\[(\\d+)\\]([^\n]+)\n", REu | REi);
@@ -32,6 +38,8 @@ protected:
 		if(!itLine.hasNext())
 			return false;
 
+		SubtitleLineBatch batch(&subtitle);
+
 		do {
 			const QRegularExpressionMatch mLine = itLine.next();
 			const Time showTime(mLine.captured(1).toInt() * 100);
@@ -39,10 +47,11 @@ protected:
 			const QString text = mLine.captured(3).replace(QChar('|'), QChar('\n'));
 
 			SubtitleLine *line = new SubtitleLine(showTime, hideTime);
-			line->primaryDoc()->setPlainText(text);
-			subtitle.insertLine(line);
+			line->setPrimaryText(RichString(text));
+			batch.append(line);
 		} while(itLine.hasNext());
 
+		batch.commit();
 		return true;
 	}
 };
@@ -25,7 +25,7 @@ protected:
 		for(SubtitleIterator it(subtitle); it.current(); ++it) {
 			const SubtitleLine *line = it.current();
 
-			QString text = (primary ? line->primaryDoc() : line->secondaryDoc())->toPlainText();
+			QString text = line->plainText(primary);
 
 			ret += m_lineBuilder.arg(static_cast<long>((line->showTime().toMillis() / 100.0) + 0.5))
 					.arg(static_cast<long>((line->hideTime().toMillis() / 100.0) + 0.5))
@@ -12,7 +12,7 @@
 #include "helpers/common.h"
 #include "formats/inputformat.h"
 
-#include <QRegularExpression>
+#include <algorithm>
 
 namespace SubtitleComposer {
 class SubRipInputFormat : public InputFormat
@@ -25,33 +25,137 @@ protected:
 
 	{}
 
+	int probe(const QString &prefix) const override
+	{
+		const ushort *it = prefix.utf16();
+		const ushort *end = it + prefix.size();
+		const ushort *cueStart;
+		Time showTime, hideTime;
+		int cues = 0;
+		while((it = findCue(it, end, &cueStart, &showTime, &hideTime)))
+			cues++;
+		return cues;
+	}
+
 	bool parseSubtitles(Subtitle &subtitle, const QString &data) const override
 	{
-		staticRE$(reTime, "[\\d]+\n([0-2][0-9]):([0-5][0-9]):([0-5][0-9])[,\\.]([0-9]+) --> ([0-2][0-9]):([0-5][0-9]):([0-5][0-9])[,\\.]([0-9]+)\n", REu);
+		const ushort *begin = data.utf16();
+		const ushort *end = begin + data.size();
 
-		QRegularExpressionMatchIterator itTime = reTime.globalMatch(data);
-		if(!itTime.hasNext())
+		const ushort *cueStart;
+		Time showTime, hideTime;
+		const ushort *textStart = findCue(begin, end, &cueStart, &showTime, &hideTime);
+		if(!textStart)
 			return false;
 
-		do {
-			QRegularExpressionMatch mTime = itTime.next();
+		SubtitleLineBatch batch(&subtitle);
 
-			Time showTime(mTime.captured(1).toInt(), mTime.captured(2).toInt(), mTime.captured(3).toInt(), mTime.captured(4).toInt());
-			Time hideTime(mTime.captured(5).toInt(), mTime.captured(6).toInt(), mTime.captured(7).toInt(), mTime.captured(8).toInt());
+		do {
+			Time nextShowTime, nextHideTime;
+			const ushort *nextTextStart = findCue(textStart, end, &cueStart, &nextShowTime, &nextHideTime);
+			const ushort *textEnd = nextTextStart ? cueStart : end;
 
-			const int off = mTime.capturedEnd();
-			const QString text = data.mid(off, itTime.hasNext() ? itTime.peekNext().capturedStart() - off : -1).trimmed();
+			// trim whitespace
+			while(textStart != textEnd && QChar(*textStart).isSpace())
+				textStart++;
+			while(textEnd != textStart && QChar(textEnd[-1]).isSpace())
+				textEnd--;
 
 			RichString stext;
-			stext.setRichString(text);
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+			stext.setRichString(QStringRef(&data, int(textStart - begin), int(textEnd - textStart)));
+#else
+			stext.setRichString(QStringView(data).mid(textStart - begin, textEnd - textStart));
+#endif
 
 			SubtitleLine *line = new SubtitleLine(showTime, hideTime);
-			line->primaryDoc()->setRichText(stext, true);
-			subtitle.insertLine(line);
-		} while(itTime.hasNext());
+			line->setPrimaryText(stext);
+			batch.append(line);
+
+			textStart = nextTextStart;
+			showTime = nextShowTime;
+			hideTime = nextHideTime;
+		} while(textStart);
 
+		batch.commit();
 		return true;
 	}
+
+private:
+	static inline bool isDigit(ushort ch) { return ch >= '0' && ch <= '9'; }
+
+	/**
+	 * @brief Length of the Unicode decimal digit that ends right before @p it, 0 if there is none
+	 *
+	 * Cue numbers accept any Unicode digit like the regular expression parser did, timestamps are ASCII only.
+	 */
+	static inline int digitBefore(const ushort *begin, const ushort *it)
+	{
+		if(it == begin)
+			return 0;
+		const ushort ch = it[-1];
+		if(ch < 0x80)
+			return isDigit(ch) ? 1 : 0;
+		if(QChar::isLowSurrogate(ch))
+			return it - 1 != begin && QChar::isHighSurrogate(it[-2]) && QChar::isDigit(QChar::surrogateToUcs4(it[-2], ch)) ? 2 : 0;
+		return QChar::isDigit(ch) ? 1 : 0;
+	}
+
+	/**
+	 * @brief Parse "HH:MM:SS,mmm" timestamp (dot is also accepted as decimal separator)
+	 * @return pointer past the timestamp or nullptr when @p it doesn't point to valid timestamp
+	 */
+	static const ushort *
+	parseTime(const ushort *it, const ushort *end, Time *time)
+	{
+		if(end - it < 10)
+			return nullptr;
+		if(it[0] < '0' || it[0] > '2' || !isDigit(it[1]) || it[2] != ':'
+				|| it[3] < '0' || it[3] > '5' || !isDigit(it[4]) || it[5] != ':'
+				|| it[6] < '0' || it[6] > '5' || !isDigit(it[7])
+				|| (it[8] != ',' && it[8] != '.') || !isDigit(it[9]))
+			return nullptr;
+
+		const int hours = (it[0] - '0') * 10 + (it[1] - '0');
+		const int minutes = (it[3] - '0') * 10 + (it[4] - '0');
+		const int seconds = (it[6] - '0') * 10 + (it[7] - '0');
+		int millis = 0;
+		for(it += 9; it != end && isDigit(*it); it++) {
+			if(millis < 100000000)
+				millis = millis * 10 + (*it - '0');
+		}
+
+		*time = Time(hours, minutes, seconds, millis);
+		return it;
+	}
+
+	/**
+	 * @brief Find next cue header ("<number>\n<show time> --> <hide time>\n") starting at @p it
+	 * @param cueStart receives start of the cue number
+	 * @return pointer to start of the cue text or nullptr if there are no more cues
+	 */
+	static const ushort *
+	findCue(const ushort *it, const ushort *end, const ushort **cueStart, Time *showTime, Time *hideTime)
+	{
+		for(const ushort *nl = it; (nl = std::find(nl, end, ushort('\n'))) != end; nl++) {
+			if(!digitBefore(it, nl))
+				continue;
+
+			const ushort *p = parseTime(nl + 1, end, showTime);
+			if(!p || end - p < 5 || p[0] != ' ' || p[1] != '-' || p[2] != '-' || p[3] != '>' || p[4] != ' ')
+				continue;
+			p = parseTime(p + 5, end, hideTime);
+			if(!p || p == end || *p != '\n')
+				continue;
+
+			const ushort *start = nl;
+			while(const int len = digitBefore(it, start))
+				start -= len;
+			*cueStart = start;
+			return p + 1;
+		}
+		return nullptr;
+	}
 };
 }
 
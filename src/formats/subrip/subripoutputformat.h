@@ -29,7 +29,7 @@ protected:
 			Time hideTime = line->hideTime();
 			ret += QString::asprintf("%d\n%02d:%02d:%02d,%03d --> %02d:%02d:%02d,%03d\n", it.index() + 1, showTime.hours(), showTime.minutes(), showTime.seconds(), showTime.millis(), hideTime.hours(), hideTime.minutes(), hideTime.seconds(), hideTime.millis());
 
-			const RichString text = (primary ? line->primaryDoc() : line->secondaryDoc())->toRichText();
+			const RichString text = line->text(primary);
 
 			ret += text.richString().replace(QLatin1String("&amp;"), QLatin1String("&")).replace(QLatin1String("&lt;"), QLatin1String("<")).replace(QLatin1String("&gt;"), QLatin1String(">"));
 
@@ -84,6 +84,21 @@ protected:
 		return ret;
 	}
 
+	int probeScriptInfo(const QString &prefix, bool advanced) const
+	{
+		staticRE$(reScriptInfo, "^ *\\[Script Info\\] *[\r\n]+", REu);
+		if(!reScriptInfo.match(prefix).hasMatch())
+			return 0;
+		// both formats can parse the data, prefer the one matching script version
+		staticRE$(reAdvanced, "[\r\n] *(?:\\[V4\\+ Styles\\]|ScriptType: *v4\\.00\\+)", REu | REi);
+		return SignatureScore + (reAdvanced.match(prefix).hasMatch() == advanced ? 1 : 0);
+	}
+
+	int probe(const QString &prefix) const override
+	{
+		return probeScriptInfo(prefix, false);
+	}
+
 	bool parseSubtitles(Subtitle &subtitle, const QString &data) const override
 	{
 		staticRE$(reScriptInfo, "^ *\\[Script Info\\] *[\r\n]+", REu);
@@ -120,6 +135,8 @@ protected:
 		staticRE$(reDialogueData, " *(Dialogue: *[^,]+, *)[^,]+(, *)[^,]+(, *[^,]+, *[^,]*, *[^,]*, *[^,]*, *[^,]*, *[^,]*, *).*", REu);
 		staticRE$(reTime, "(\\d+):(\\d+):(\\d+).(\\d+)", REu);
 
+		SubtitleLineBatch batch(&subtitle);
+
 		do {
 			QRegularExpressionMatch mFormat = itFormat.next();
 			QRegularExpressionMatchIterator itDialogue = reDialogue.globalMatch(data, mFormat.capturedEnd());
@@ -143,15 +160,16 @@ protected:
 				Time hideTime(mTime.captured(1).toInt(), mTime.captured(2).toInt(), mTime.captured(3).toInt(), mTime.captured(4).toInt() * 10);
 
 				SubtitleLine *line = new SubtitleLine(showTime, hideTime);
-				line->primaryDoc()->setRichText(toRichString(mDialogue.captured(3)), true);
+				line->setPrimaryText(toRichString(mDialogue.captured(3)));
 
 				formatData.setValue($("Dialogue"), mDialogue.captured(0).replace(reDialogueData, $("\\1%1\\2%2\\3%3\n")));
 				setFormatData(line, &formatData);
 
-				subtitle.insertLine(line);
+				batch.append(line);
 			}
 		} while(itFormat.hasNext());
 
+		batch.commit();
 		return true;
 	}
 
@@ -170,6 +188,11 @@ protected:
 	AdvancedSubStationAlphaInputFormat()
 		: SubStationAlphaInputFormat($("Advanced SubStation Alpha"), QStringList($("ass")))
 	{}
+
+	int probe(const QString &prefix) const override
+	{
+		return probeScriptInfo(prefix, true);
+	}
 };
 
 }
@@ -117,7 +117,7 @@ protected:
 
 			formatData = this->formatData(line);
 
-			RichString stext = (primary ? line->primaryDoc() : line->secondaryDoc())->toRichText();
+			RichString stext = line->text(primary);
 			ret += QString(formatData ? formatData->value(QStringLiteral("Dialogue")) : m_dialogueBuilder)
 					.arg(showTimeArg, hideTimeArg, fromRichString(stext));
 		}
@@ -24,6 +24,12 @@ protected:
 		: InputFormat($("SubViewer 1.0"), QStringList($("sub")))
 	{}
 
+	int probe(const QString &prefix) const override
+	{
+		staticRE$(reTime, "(?:^|\n)\\[[0-2][0-9]:[0-5][0-9]:[0-5][0-9]\\]\n", REu);
+		return probeMatches(reTime, prefix);
+	}
+
 	bool parseSubtitles(Subtitle &subtitle, const QString &data) const override
 	{
 		staticRE$(reTime, "\\[([0-2][0-9]):([0-5][0-9]):([0-5][0-9])\\]\\n([^\n]*)\\n", REu);
@@ -31,6 +37,8 @@ protected:
 		if(!itTime.hasNext())
 			return false;
 
+		SubtitleLineBatch batch(&subtitle);
+
 		for(;;) {
 			QRegularExpressionMatch mTime = itTime.next();
 
@@ -44,11 +52,12 @@ protected:
 			const Time hideTime(mTime.captured(1).toInt(), mTime.captured(2).toInt(), mTime.captured(3).toInt(), 0);
 
 			SubtitleLine *l = new SubtitleLine(showTime, hideTime);
-			l->primaryDoc()->setPlainText(text);
-			subtitle.insertLine(l);
+			l->setPrimaryText(RichString(text));
+			batch.append(l);
 
 		}
 
+		batch.commit();
 		return subtitle.count() > 0;
 	}
 };
@@ -24,6 +24,12 @@ protected:
 		: InputFormat($("SubViewer 2.0"), QStringList($("sub")))
 	{}
 
+	int probe(const QString &prefix) const override
+	{
+		staticRE$(reTime, "(?:^|\n)[0-2][0-9]:[0-5][0-9]:[0-5][0-9]\\.[0-9][0-9],[0-2][0-9]:[0-5][0-9]:[0-5][0-9]\\.[0-9][0-9]\n", REu);
+		return probeMatches(reTime, prefix);
+	}
+
 	bool parseSubtitles(Subtitle &subtitle, const QString &data) const override
 	{
 		staticRE$(reLine,
@@ -34,6 +40,8 @@ protected:
 		if(!itLine.hasNext())
 			return false;
 
+		SubtitleLineBatch batch(&subtitle);
+
 		do {
 			QRegularExpressionMatch mLine = itLine.next();
 
@@ -57,11 +65,12 @@ protected:
 			}
 
 			SubtitleLine *l = new SubtitleLine(showTime, hideTime);
-			l->primaryDoc()->setRichText(RichString(text, styleFlags), true);
-			subtitle.insertLine(l);
+			l->setPrimaryText(RichString(text, styleFlags));
+			batch.append(l);
 
 		} while(itLine.hasNext());
 
+		batch.commit();
 		return subtitle.count() > 0;
 	}
 };
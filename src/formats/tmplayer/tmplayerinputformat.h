@@ -24,7 +24,8 @@ class TMPlayerInputFormat : public InputFormat
 protected:
 	TMPlayerInputFormat(const QString &name, const QStringList &extensions, const QString &re)
 		: InputFormat(name, extensions),
-		  m_reTime(re)
+		  m_reTime(re),
+		  m_reProbe(QChar('^') + re, QRegularExpression::MultilineOption)
 	{}
 
 	TMPlayerInputFormat()
@@ -32,12 +33,19 @@ protected:
 							  $("([0-2]?[0-9]):([0-5][0-9]):([0-5][0-9]):([^\n]*)\n?"))
 	{}
 
+	int probe(const QString &prefix) const override
+	{
+		return probeMatches(m_reProbe, prefix);
+	}
+
 	bool parseSubtitles(Subtitle &subtitle, const QString &data) const override
 	{
 		QRegularExpressionMatchIterator itTime = m_reTime.globalMatch(data);
 		if(!itTime.hasNext())
 			return false;
 
+		SubtitleLineBatch batch(&subtitle);
+
 		do {
 			QRegularExpressionMatch mTime = itTime.next();
 
@@ -58,14 +66,16 @@ protected:
 			}
 
 			SubtitleLine *l = new SubtitleLine(showTime, hideTime);
-			l->primaryDoc()->setPlainText(text);
-			subtitle.insertLine(l);
+			l->setPrimaryText(RichString(text));
+			batch.append(l);
 		} while(itTime.hasNext());
 
+		batch.commit();
 		return subtitle.count() > 0;
 	}
 
 	QRegularExpression m_reTime;
+	QRegularExpression m_reProbe;
 };
 
 class TMPlayerPlusInputFormat : public TMPlayerInputFormat
@@ -28,7 +28,7 @@ protected:
 			Time showTime = line->showTime();
 			ret += QString::asprintf(m_timeFormat, showTime.hours(), showTime.minutes(), showTime.seconds());
 
-			QString text = (primary ? line->primaryDoc() : line->secondaryDoc())->toPlainText();
+			QString text = line->plainText(primary);
 			ret += text.replace('\n', '|');
 			ret += '\n';
 
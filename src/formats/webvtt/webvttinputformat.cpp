@@ -212,6 +212,12 @@ parseCueSettings(SubtitleLine *line, QStringView_ css)
 	line->setPosition(p);
 }
 
+int
+WebVTTInputFormat::probe(const QString &prefix) const
+{
+	return prefix.startsWith($("WEBVTT")) ? SignatureScore : 0;
+}
+
 bool
 WebVTTInputFormat::parseSubtitles(Subtitle &subtitle, const QString &data) const
 {
@@ -230,6 +236,8 @@ WebVTTInputFormat::parseSubtitles(Subtitle &subtitle, const QString &data) const
 	subtitle.stylesheetClear();
 
 	// https://w3c.github.io/webvtt/
+	SubtitleLineBatch batch(&subtitle);
+
 	while(off < data.length()) {
 		if(QStringView(data).mid(off, 5) == $("STYLE")) {
 			if(!notes.isEmpty()) { // store note before style
@@ -283,7 +291,7 @@ WebVTTInputFormat::parseSubtitles(Subtitle &subtitle, const QString &data) const
 		// TODO: handle pseudo classes
 		// https://developer.mozilla.org/en-US/docs/Web/API/WebVTT_API#css_pseudo-classes
 		stext.setRichString(cueText.toString());
-		line->primaryDoc()->setRichText(stext, true);
+		line->setPrimaryText(stext);
 
 		if(!notes.isEmpty()) {
 			QString comment;
@@ -299,7 +307,7 @@ WebVTTInputFormat::parseSubtitles(Subtitle &subtitle, const QString &data) const
 			parseCueSettings(line, cueSettings);
 		if(!cueId.isEmpty())
 			line->meta("id", cueId.toString());
-		subtitle.insertLine(line);
+		batch.append(line);
 	}
 
 	if(!notes.isEmpty()) {
@@ -309,5 +317,6 @@ WebVTTInputFormat::parseSubtitles(Subtitle &subtitle, const QString &data) const
 		notes.clear();
 	}
 
+	batch.commit();
 	return true;
 }
@@ -15,6 +15,7 @@ class WebVTTInputFormat : public InputFormat
 	friend class FormatManager;
 
 protected:
+	int probe(const QString &prefix) const override;
 	bool parseSubtitles(Subtitle &subtitle, const QString &data) const override;
 
 	WebVTTInputFormat();
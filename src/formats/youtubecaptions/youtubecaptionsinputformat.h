@@ -24,6 +24,12 @@ protected:
 		: InputFormat($("YouTube Captions"), QStringList($("sbv")))
 	{}
 
+	int probe(const QString &prefix) const override
+	{
+		staticRE$(reTime, "(?:^|\n)\\d+:[0-5][0-9]:[0-5][0-9][,\\.][0-9]{3},\\d+:[0-5][0-9]:[0-5][0-9][,\\.][0-9]{3}\n", REu);
+		return probeMatches(reTime, prefix);
+	}
+
 	bool parseSubtitles(Subtitle &subtitle, const QString &data) const override
 	{
 		staticRE$(reTime,
@@ -34,6 +40,8 @@ protected:
 		if(!it.hasNext())
 			return false;
 
+		SubtitleLineBatch batch(&subtitle);
+
 		do {
 			QRegularExpressionMatch tm = it.next();
 			const Time showTime(tm.captured(2).toInt(), tm.captured(3).toInt(), tm.captured(4).toInt(), tm.captured(5).toInt());
@@ -46,10 +54,11 @@ protected:
 			// if so, does it use standard HTML style tags?
 
 			SubtitleLine *l = new SubtitleLine(showTime, hideTime);
-			l->primaryDoc()->setHtml(text, true);
-			subtitle.insertLine(l);
+			l->setPrimaryText(RichString::fromRichString(text));
+			batch.append(l);
 		} while(it.hasNext());
 
+		batch.commit();
 		return subtitle.count() > 0;
 	}
 };
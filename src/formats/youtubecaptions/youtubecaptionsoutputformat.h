@@ -31,7 +31,7 @@ protected:
 				ts.hours(), ts.minutes(), ts.seconds(), ts.millis(),
 				th.hours(), th.minutes(), th.seconds(), th.millis());
 
-			const RichString text = (primary ? ln->primaryDoc() : ln->secondaryDoc())->toRichText();
+			const RichString text = ln->text(primary);
 
 			// TODO does the format actually supports styled text?
 			// if so, does it use standard HTML style tags?
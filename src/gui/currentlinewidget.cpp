@@ -380,14 +380,17 @@ CurrentLineWidget::saveConfig()
 void
 CurrentLineWidget::setSubtitle(Subtitle *subtitle)
 {
-	if(m_subtitle)
+	if(m_subtitle) {
 		disconnect(m_subtitle.constData(), &Subtitle::lineAnchorChanged, this, &CurrentLineWidget::onLineAnchorChanged);
+		disconnect(m_subtitle.constData(), &Subtitle::linesTimesChanged, this, &CurrentLineWidget::onLinesTimesChanged);
+	}
 
 	m_subtitle = subtitle;
 
-	if(subtitle)
+	if(subtitle) {
 		connect(m_subtitle.constData(), &Subtitle::lineAnchorChanged, this, &CurrentLineWidget::onLineAnchorChanged);
-	else
+		connect(m_subtitle.constData(), &Subtitle::linesTimesChanged, this, &CurrentLineWidget::onLinesTimesChanged);
+	} else
 		setCurrentLine(nullptr);
 }
 
@@ -557,6 +560,16 @@ CurrentLineWidget::onLineTimesChanged(const Time &showTime, const Time &hideTime
 	updateLabels();
 }
 
+void
+CurrentLineWidget::onLinesTimesChanged(int firstIndex, int lastIndex)
+{
+	if(!m_currentLine)
+		return;
+	const int index = m_currentLine->index();
+	if(index >= firstIndex && index <= lastIndex)
+		onLineTimesChanged(m_currentLine->showTime(), m_currentLine->hideTime());
+}
+
 void
 CurrentLineWidget::onLineShowTimeChanged(const Time &showTime)
 {
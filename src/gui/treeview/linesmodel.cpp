@@ -56,6 +56,8 @@ LinesModel::setSubtitle(Subtitle *subtitle)
 			disconnect(m_subtitle.constData(), &Subtitle::linesInserted, this, &LinesModel::onLinesInserted);
 			disconnect(m_subtitle.constData(), &Subtitle::linesAboutToBeRemoved, this, &LinesModel::onLinesAboutToRemove);
 			disconnect(m_subtitle.constData(), &Subtitle::linesRemoved, this, &LinesModel::onLinesRemoved);
+			disconnect(m_subtitle.constData(), &Subtitle::linesAboutToBeReordered, this, &LinesModel::onLinesAboutToReorder);
+			disconnect(m_subtitle.constData(), &Subtitle::linesReordered, this, &LinesModel::onLinesReordered);
 
 			disconnect(m_subtitle.constData(), &Subtitle::lineAnchorChanged, this, &LinesModel::onLineChanged);
 			disconnect(m_subtitle.constData(), &Subtitle::lineErrorFlagsChanged, this, &LinesModel::onLineChanged);
@@ -63,6 +65,7 @@ LinesModel::setSubtitle(Subtitle *subtitle)
 			disconnect(m_subtitle.constData(), &Subtitle::lineSecondaryTextChanged, this, &LinesModel::onLineChanged);
 			disconnect(m_subtitle.constData(), &Subtitle::lineShowTimeChanged, this, &LinesModel::onLineChanged);
 			disconnect(m_subtitle.constData(), &Subtitle::lineHideTimeChanged, this, &LinesModel::onLineChanged);
+			disconnect(m_subtitle.constData(), &Subtitle::linesTimesChanged, this, &LinesModel::onLinesTimesChanged);
 
 			disconnect(m_subtitle->stylesheet(), &RichCSS::changed, this, &LinesModel::onLinesChanged);
 
@@ -82,6 +85,8 @@ LinesModel::setSubtitle(Subtitle *subtitle)
 			connect(m_subtitle.constData(), &Subtitle::linesInserted, this, &LinesModel::onLinesInserted);
 			connect(m_subtitle.constData(), &Subtitle::linesAboutToBeRemoved, this, &LinesModel::onLinesAboutToRemove);
 			connect(m_subtitle.constData(), &Subtitle::linesRemoved, this, &LinesModel::onLinesRemoved);
+			connect(m_subtitle.constData(), &Subtitle::linesAboutToBeReordered, this, &LinesModel::onLinesAboutToReorder);
+			connect(m_subtitle.constData(), &Subtitle::linesReordered, this, &LinesModel::onLinesReordered);
 
 			connect(m_subtitle.constData(), &Subtitle::lineAnchorChanged, this, &LinesModel::onLineChanged);
 			connect(m_subtitle.constData(), &Subtitle::lineErrorFlagsChanged, this, &LinesModel::onLineChanged);
@@ -89,6 +94,7 @@ LinesModel::setSubtitle(Subtitle *subtitle)
 			connect(m_subtitle.constData(), &Subtitle::lineSecondaryTextChanged, this, &LinesModel::onLineChanged);
 			connect(m_subtitle.constData(), &Subtitle::lineShowTimeChanged, this, &LinesModel::onLineChanged);
 			connect(m_subtitle.constData(), &Subtitle::lineHideTimeChanged, this, &LinesModel::onLineChanged);
+			connect(m_subtitle.constData(), &Subtitle::linesTimesChanged, this, &LinesModel::onLinesTimesChanged);
 
 			connect(m_subtitle->stylesheet(), &RichCSS::changed, this, &LinesModel::onLinesChanged);
 		}
@@ -319,6 +325,30 @@ LinesModel::onLinesRemoved(int firstIndex, int lastIndex)
 	m_resetModelTimer->start();
 }
 
+void
+LinesModel::onLinesAboutToReorder(int firstIndex, int lastIndex)
+{
+	Q_UNUSED(firstIndex);
+	Q_UNUSED(lastIndex);
+	// selected rows will point to other lines, keep only current line selected
+	LinesWidget *lw = static_cast<LinesWidget *>(parent());
+	QItemSelectionModel *sm = lw->selectionModel();
+	m_resetModelSelection.first = m_resetModelSelection.second = m_subtitle->line(sm->currentIndex().row());
+	m_resetModelResumeEditing = lw->isEditing();
+	{
+		QSignalBlocker s(sm);
+		sm->clear();
+	}
+}
+
+void
+LinesModel::onLinesReordered(int firstIndex, int lastIndex)
+{
+	Q_UNUSED(firstIndex);
+	Q_UNUSED(lastIndex);
+	m_resetModelTimer->start();
+}
+
 void
 LinesModel::onModelReset()
 {
@@ -378,6 +408,19 @@ LinesModel::onLineChanged(const SubtitleLine *line)
 	}
 }
 
+void
+LinesModel::onLinesTimesChanged(int firstIndex, int lastIndex)
+{
+	if(m_minChangedLineIndex < 0) {
+		m_minChangedLineIndex = firstIndex;
+		m_maxChangedLineIndex = lastIndex;
+		m_dataChangedTimer->start();
+	} else {
+		m_minChangedLineIndex = qMin(m_minChangedLineIndex, firstIndex);
+		m_maxChangedLineIndex = qMax(m_maxChangedLineIndex, lastIndex);
+	}
+}
+
 void
 LinesModel::onLinesChanged()
 {
@@ -55,9 +55,12 @@ private slots:
 	void onLinesInserted(int firstIndex, int lastIndex);
 	void onLinesAboutToRemove(int firstIndex, int lastIndex);
 	void onLinesRemoved(int firstIndex, int lastIndex);
+	void onLinesAboutToReorder(int firstIndex, int lastIndex);
+	void onLinesReordered(int firstIndex, int lastIndex);
 	void onModelReset();
 
 	void onLineChanged(const SubtitleLine *line);
+	void onLinesTimesChanged(int firstIndex, int lastIndex);
 	void onLinesChanged();
 	void emitDataChanged();
 
@@ -7,13 +7,20 @@
 #include "wavebuffer.h"
 
 #include "application.h"
+#include "scconfig.h"
+#include "gui/waveform/wavecache.h"
 #include "gui/waveform/waveformwidget.h"
+#include "gui/waveform/wavepyramid.h"
 #include "gui/waveform/zoombuffer.h"
 
+#include <QDebug>
 #include <QProgressBar>
 #include <QScrollBar>
+#include <QThread>
 #include <QtMath>
 
+#include <limits>
+
 #define MAX_WINDOW_ZOOM 3000 // TODO: calculate this when receiving stream data and do sample rate conversion
 //#define SAMPLE_RATE 8000
 //#define SAMPLE_RATE_MILLIS (SAMPLE_RATE / 1000)
@@ -21,25 +28,52 @@
 
 
 namespace SubtitleComposer {
+struct WaveformSegment {
+	WaveformSegment()
+		: start(0),
+		  offset(0),
+		  overflow(0),
+		  val(nullptr)
+	{
+	}
+
+	quint32 start;
+	quint32 offset;
+	quint16 overflow;
+	qint32 *val;
+};
+
 struct WaveformFrame {
 	explicit WaveformFrame(quint8 shift, quint8 channels)
 		: offset(0),
 		  sampleShift(shift),
-		  frameSize((1 << sampleShift) * channels),
-		  overflow(0),
-		  val(new qint32[channels])
+		  channels(channels),
+		  frameSize((1 << sampleShift) * channels)
 	{
 	}
 
 	virtual ~WaveformFrame() {
-		delete[] val;
+		for(const WaveformSegment &seg: qAsConst(segments))
+			delete[] seg.val;
 	}
 
-	quint32 offset;
+	WaveformSegment * segment(int index, quint32 inStartOffset) {
+		while(segments.size() <= index)
+			segments.push_back(WaveformSegment());
+		WaveformSegment *seg = &segments[index];
+		if(!seg->val) {
+			seg->val = new qint32[channels];
+			// first segment is padded from stream start
+			seg->start = seg->offset = index ? inStartOffset : 0;
+		}
+		return seg;
+	}
+
+	quint32 offset; // samples available without gaps from stream start
 	quint8 sampleShift;
+	quint8 channels;
 	quint16 frameSize;
-	quint16 overflow;
-	qint32 *val;
+	QVector<WaveformSegment> segments;
 };
 }
 
@@ -56,12 +90,25 @@ WaveBuffer::WaveBuffer(WaveformWidget *parent)
 	  m_waveform(nullptr),
 	  m_samplesSec(0),
 	  m_wfFrame(nullptr),
+	  m_pyramid(new WavePyramid()),
+	  m_cacheWriter(nullptr),
 	  m_zoomBuffer(new ZoomBuffer(this))
 {
 	connect(m_stream, &StreamProcessor::streamProgress, this, &WaveBuffer::onStreamProgress);
 	connect(m_stream, &StreamProcessor::streamFinished, this, &WaveBuffer::onStreamFinished);
 	// Using Qt::DirectConnection here makes WaveBuffer::onStreamData() to execute in SpeechProcessor's thread
 	connect(m_stream, &StreamProcessor::audioDataAvailable, this, &WaveBuffer::onStreamData, Qt::DirectConnection);
+	// don't cache partially decoded waveform
+	connect(m_stream, &StreamProcessor::streamError, this, [this](){ m_cacheFile.clear(); });
+}
+
+WaveBuffer::~WaveBuffer()
+{
+	if(m_cacheWriter) {
+		m_cacheWriter->wait();
+		delete m_cacheWriter;
+	}
+	delete m_pyramid;
 }
 
 quint32
@@ -81,7 +128,12 @@ WaveBuffer::setAudioStream(const QString &mediaFile, int audioStream)
 {
 	m_waveformDuration = 0;
 
+	m_cacheFile = SCConfig::wfCacheSize() > 0 ? WaveCache::cacheFile(mediaFile, audioStream) : QString();
+	if(!m_cacheFile.isEmpty() && loadCache())
+		return;
+
 	static WaveFormat waveFormat(0, 0, sizeof(SAMPLE_TYPE) * 8, true);
+	m_stream->setAudioSegments(QThread::idealThreadCount());
 	if(m_stream->open(mediaFile) && m_stream->initAudio(audioStream, waveFormat))
 		m_stream->start();
 }
@@ -99,10 +151,18 @@ WaveBuffer::setNullAudioStream(quint64 msecVideoLength)
 void
 WaveBuffer::clearAudioStream()
 {
+	m_cacheFile.clear();
 	m_stream->close();
 
+	if(m_cacheWriter) {
+		m_cacheWriter->wait();
+		delete m_cacheWriter;
+		m_cacheWriter = nullptr;
+	}
+
 	if(m_waveform) {
 		m_zoomBuffer->setWaveform(nullptr);
+		m_pyramid->clear();
 		for(quint32 i = 0; i < m_waveformChannels; i++)
 			delete[] m_waveform[i];
 		delete[] m_waveform;
@@ -130,12 +190,57 @@ WaveBuffer::onStreamFinished()
 {
 	m_wfWidget->m_progressWidget->hide();
 	if(m_wfFrame) {
+		// decoding is done, fill any gaps left between segments
+		updateSamplesAvailable(std::numeric_limits<quint32>::max());
 		m_waveformChannelSize = m_wfFrame->offset;
+		m_pyramid->update(m_waveformChannelSize);
 		delete m_wfFrame;
 		m_wfFrame = nullptr;
+
+		if(!m_cacheFile.isEmpty())
+			storeCache();
 	}
 }
 
+bool
+WaveBuffer::loadCache()
+{
+	if(!WaveCache::load(m_cacheFile, &m_waveformDuration, &m_samplesSec, &m_waveformChannels, &m_waveformChannelSize, &m_waveform))
+		return false;
+
+	m_pyramid->reset(m_waveform, m_waveformChannels, m_waveformChannelSize);
+	m_pyramid->update(m_waveformChannelSize);
+	m_zoomBuffer->setWaveform(m_waveform);
+
+	m_wfWidget->m_scrollBar->setRange(0, m_waveformDuration * 1000 - m_wfWidget->windowSizeInner());
+
+	emit waveformUpdated();
+	return true;
+}
+
+void
+WaveBuffer::storeCache()
+{
+	if(m_cacheWriter) {
+		m_cacheWriter->wait();
+		delete m_cacheWriter;
+	}
+
+	// waveform is not modified after decoding and clearAudioStream() waits for the writer before freeing it
+	const QString cacheFile = m_cacheFile;
+	const quint32 duration = m_waveformDuration;
+	const quint32 sampleRate = m_samplesSec;
+	const quint16 channels = m_waveformChannels;
+	const quint32 channelSize = m_waveformChannelSize;
+	const SAMPLE_TYPE * const *waveform = m_waveform;
+	const qint64 maxSize = qint64(SCConfig::wfCacheSize()) << 20;
+	m_cacheWriter = QThread::create([=](){
+		if(WaveCache::store(cacheFile, duration, sampleRate, channels, channelSize, waveform))
+			WaveCache::evict(maxSize);
+	});
+	m_cacheWriter->start();
+}
+
 inline static SAMPLE_TYPE
 scaleSample(SAMPLE_TYPE sample)
 {
@@ -144,7 +249,35 @@ scaleSample(SAMPLE_TYPE sample)
 }
 
 void
-WaveBuffer::onStreamData(const void *buffer, qint32 size, const WaveFormat *waveFormat, const qint64 msecStart, const qint64 /*msecDuration*/)
+WaveBuffer::updateSamplesAvailable(quint32 maxGap)
+{
+	const QVector<WaveformSegment> &segments = m_wfFrame->segments;
+	if(segments.isEmpty() || !segments.first().val)
+		return;
+
+	quint32 available = segments.first().offset;
+	for(int i = 1; i < segments.size(); i++) {
+		const WaveformSegment &seg = segments.at(i);
+		// segment without data is part of the gap before next one
+		if(!seg.val)
+			continue;
+		if(seg.start > available && seg.start - available > maxGap)
+			break;
+		// only decoding errors leave gaps bigger than timestamp jitter
+		if(seg.start > available && seg.start - available > m_samplesSec / 10)
+			qWarning() << "Waveform samples" << available << "to" << seg.start << "were not decoded, filling them flat";
+		// pad small gap between segments
+		for(; available < seg.start; available++) {
+			for(quint32 c = 0; c < m_waveformChannels; c++)
+				m_waveform[c][available] = available ? m_waveform[c][available - 1] : 0;
+		}
+		available = qMax(available, seg.offset);
+	}
+	m_wfFrame->offset = available;
+}
+
+void
+WaveBuffer::onStreamData(const void *buffer, qint32 size, const WaveFormat *waveFormat, const qint64 msecStart, const qint64 /*msecDuration*/, const int segment)
 {
 	// make sure WaveBuffer::onStreamProgress() signal was processed since we're in different thread
 	while(!m_waveformDuration) {
@@ -168,6 +301,7 @@ WaveBuffer::onStreamData(const void *buffer, qint32 size, const WaveFormat *wave
 
 		m_wfFrame = new WaveformFrame(sampleShift, m_waveformChannels);
 
+		m_pyramid->reset(m_waveform, m_waveformChannels, m_waveformChannelSize);
 		m_zoomBuffer->setWaveform(m_waveform);
 
 		emit waveformUpdated();
@@ -177,65 +311,78 @@ WaveBuffer::onStreamData(const void *buffer, qint32 size, const WaveFormat *wave
 
 	const SAMPLE_TYPE *sample = reinterpret_cast<const SAMPLE_TYPE *>(buffer);
 
+	const quint32 inStartOffset = qMin(quint64(qMax(0LL, msecStart)) * m_samplesSec / 1000, quint64(m_waveformChannelSize - 1));
+	WaveformSegment *seg = m_wfFrame->segment(segment, inStartOffset);
+	// samples written below available offset replace padding or overlap and have to be zoomed again
+	const quint32 writeStart = qMin(seg->offset, inStartOffset);
+
 	{ // handle overlaps and holes between buffers (tested streams had ~2ms error - might be useless)
-		const quint32 inStartOffset = qMax(0LL, msecStart) * m_samplesSec / 1000;
-		if(inStartOffset < m_wfFrame->offset) {
+		if(inStartOffset < seg->offset) {
 			// overwrite part of local buffer
-			m_wfFrame->offset = inStartOffset;
-		} else if(inStartOffset > m_wfFrame->offset) {
+			seg->offset = inStartOffset;
+		} else if(inStartOffset > seg->offset) {
 			// pad hole in local buffer
-			quint32 i = m_wfFrame->offset;
-			if(i > 0) {
+			quint32 i = seg->offset;
+			if(i > seg->start) {
 				for(; i < inStartOffset; i++) {
 					for(quint32 c = 0; c < m_waveformChannels; c++)
 						m_waveform[c][i] = m_waveform[c][i - 1];
 				}
 			} else {
 				for(quint32 c = 0; c < m_waveformChannels; c++)
-					memset(m_waveform[c], 0, inStartOffset * sizeof(SAMPLE_TYPE));
+					memset(m_waveform[c] + i, 0, (inStartOffset - i) * sizeof(SAMPLE_TYPE));
 			}
-			m_wfFrame->offset = inStartOffset;
+			seg->offset = inStartOffset;
 		}
+		// neighbour segments can overlap already reduced samples too
+		m_pyramid->rewind(seg->offset);
 	}
 
 	Q_ASSERT(m_waveformChannels > 0);
 
 	quint32 len = size / sizeof(SAMPLE_TYPE);
 
-	if(m_wfFrame->overflow) {
-		const quint32 overflowFrameSize = qMin(m_wfFrame->overflow + len, quint32(m_wfFrame->frameSize));
+	if(seg->overflow) {
+		const quint32 overflowFrameSize = qMin(seg->overflow + len, quint32(m_wfFrame->frameSize));
 
-		quint32 c = m_wfFrame->overflow;
+		quint32 c = seg->overflow;
 		for(; c < m_waveformChannels; c++)
-			m_wfFrame->val[c] = *sample++;
+			seg->val[c] = *sample++;
 		for(; c < overflowFrameSize; c++)
-			m_wfFrame->val[c % m_waveformChannels] += *sample++;
+			seg->val[c % m_waveformChannels] += *sample++;
 		for(c = 0; c < m_waveformChannels; c++)
-			m_waveform[c][m_wfFrame->offset] = scaleSample(m_wfFrame->val[c] >> m_wfFrame->sampleShift);
+			m_waveform[c][seg->offset] = scaleSample(seg->val[c] >> m_wfFrame->sampleShift);
 
-		len -= overflowFrameSize - m_wfFrame->overflow;
+		len -= overflowFrameSize - seg->overflow;
 		if(overflowFrameSize < m_wfFrame->frameSize) {
 			// no more data
 			Q_ASSERT(len == 0);
-			m_wfFrame->overflow = overflowFrameSize;
+			seg->overflow = overflowFrameSize;
 			return;
 		}
-		m_wfFrame->offset++;
+		seg->offset++;
 	}
 
-	if(m_wfFrame->offset + (len >> m_wfFrame->sampleShift) >= m_waveformChannelSize) // make sure we don't overflow
-		len = (m_waveformChannelSize - m_wfFrame->offset - 1) << m_wfFrame->sampleShift;
+	if(seg->offset + (len >> m_wfFrame->sampleShift) >= m_waveformChannelSize) // make sure we don't overflow
+		len = (m_waveformChannelSize - seg->offset - 1) << m_wfFrame->sampleShift;
 
 	while(len > m_wfFrame->frameSize) {
 		quint32 c = 0;
 		for(; c < m_waveformChannels; c++)
-			m_wfFrame->val[c] = *sample++;
+			seg->val[c] = *sample++;
 		for(; c < m_wfFrame->frameSize; c++)
-			m_wfFrame->val[c % m_waveformChannels] += *sample++;
+			seg->val[c % m_waveformChannels] += *sample++;
 		for(c = 0; c < m_waveformChannels; c++)
-			m_waveform[c][m_wfFrame->offset] = scaleSample(m_wfFrame->val[c] >> m_wfFrame->sampleShift);
+			m_waveform[c][seg->offset] = scaleSample(seg->val[c] >> m_wfFrame->sampleShift);
 		len -= m_wfFrame->frameSize;
-		m_wfFrame->offset++;
+		seg->offset++;
 	}
-	m_wfFrame->overflow = len;
+	seg->overflow = len;
+
+	const quint32 available = m_wfFrame->offset;
+	updateSamplesAvailable(m_samplesSec / 10);
+	m_pyramid->update(m_wfFrame->offset);
+
+	if(writeStart < available)
+		m_zoomBuffer->invalidate(writeStart, qMin(seg->offset, available));
 }
@@ -24,6 +24,7 @@
 
 namespace SubtitleComposer {
 class WaveformWidget;
+class WavePyramid;
 class ZoomBuffer;
 
 struct WaveZoomData {
@@ -37,6 +38,7 @@ class WaveBuffer : public QObject
 
 public:
 	explicit WaveBuffer(WaveformWidget *parent = nullptr);
+	virtual ~WaveBuffer();
 
 	/**
 	 * @brief waveformDuration
@@ -72,15 +74,21 @@ public:
 	void clearAudioStream();
 
 	inline ZoomBuffer * zoomBuffer() const { return m_zoomBuffer; }
+	inline const WavePyramid * pyramid() const { return m_pyramid; }
 
 signals:
 	void waveformUpdated();
 
 private:
-	void onStreamData(const void *buffer, qint32 size, const WaveFormat *waveFormat, const qint64 msecStart, const qint64 msecDuration);
+	void onStreamData(const void *buffer, qint32 size, const WaveFormat *waveFormat, const qint64 msecStart, const qint64 msecDuration, const int segment);
 	void onStreamProgress(quint64 msecPos, quint64 msecLength);
 	void onStreamFinished();
 
+	void updateSamplesAvailable(quint32 maxGap);
+
+	bool loadCache();
+	void storeCache();
+
 private:
 	WaveformWidget *m_wfWidget;
 
@@ -95,6 +103,11 @@ private:
 
 	struct WaveformFrame *m_wfFrame;
 
+	WavePyramid *m_pyramid;
+
+	QString m_cacheFile;
+	QThread *m_cacheWriter;
+
 	ZoomBuffer *m_zoomBuffer;
 };
 }
@@ -0,0 +1,131 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "wavecache.h"
+
+#include "helpers/common.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QSysInfo>
+
+#define CACHE_MAGIC 0x53435746 // "SCWF"
+#define CACHE_VERSION 1
+
+using namespace SubtitleComposer;
+
+QString
+WaveCache::cacheDir()
+{
+	return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + $("/waveforms");
+}
+
+QString
+WaveCache::cacheFile(const QString &mediaFile, int audioStream)
+{
+	const QFileInfo fi(mediaFile);
+	if(!fi.isFile())
+		return QString();
+
+	QByteArray key = fi.canonicalFilePath().toUtf8();
+	key.append('\n').append(QByteArray::number(fi.size()));
+	key.append('\n').append(QByteArray::number(fi.lastModified().toMSecsSinceEpoch()));
+	key.append('\n').append(QByteArray::number(audioStream));
+
+	return cacheDir() + QChar('/') + QString::fromLatin1(QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex()) + $(".wfc");
+}
+
+bool
+WaveCache::load(const QString &cacheFile, quint32 *duration, quint32 *sampleRate, quint16 *channels, quint32 *channelSize, SAMPLE_TYPE ***waveform)
+{
+	QFile file(cacheFile);
+	if(!file.open(QIODevice::ReadOnly))
+		return false;
+
+	QDataStream in(&file);
+	quint32 magic, wfDuration, wfSampleRate, wfSize;
+	quint16 version, wfChannels;
+	quint8 sampleBits, byteOrder;
+	in >> magic >> version >> sampleBits >> byteOrder >> wfDuration >> wfSampleRate >> wfChannels >> wfSize;
+	if(in.status() != QDataStream::Ok || magic != CACHE_MAGIC || version != CACHE_VERSION
+			|| sampleBits != sizeof(SAMPLE_TYPE) * 8 || byteOrder != QSysInfo::ByteOrder
+			|| !wfSampleRate || !wfChannels || !wfSize)
+		return false;
+
+	const qint64 channelBytes = qint64(wfSize) * sizeof(SAMPLE_TYPE);
+	if(file.size() - file.pos() != channelBytes * wfChannels) {
+		qWarning() << "Waveform cache" << cacheFile << "is truncated";
+		return false;
+	}
+
+	SAMPLE_TYPE **wf = new SAMPLE_TYPE *[wfChannels];
+	for(quint16 ch = 0; ch < wfChannels; ch++) {
+		wf[ch] = new SAMPLE_TYPE[wfSize];
+		if(file.read(reinterpret_cast<char *>(wf[ch]), channelBytes) != channelBytes) {
+			for(quint16 i = 0; i <= ch; i++)
+				delete[] wf[i];
+			delete[] wf;
+			return false;
+		}
+	}
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+	// mark as recently used
+	file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+#endif
+
+	*duration = wfDuration;
+	*sampleRate = wfSampleRate;
+	*channels = wfChannels;
+	*channelSize = wfSize;
+	*waveform = wf;
+	return true;
+}
+
+bool
+WaveCache::store(const QString &cacheFile, quint32 duration, quint32 sampleRate, quint16 channels, quint32 channelSize, const SAMPLE_TYPE * const *waveform)
+{
+	if(!QDir().mkpath(QFileInfo(cacheFile).absolutePath()))
+		return false;
+
+	QSaveFile file(cacheFile);
+	if(!file.open(QIODevice::WriteOnly))
+		return false;
+
+	QDataStream out(&file);
+	out << quint32(CACHE_MAGIC) << quint16(CACHE_VERSION) << quint8(sizeof(SAMPLE_TYPE) * 8) << quint8(QSysInfo::ByteOrder)
+		<< duration << sampleRate << channels << channelSize;
+
+	const qint64 channelBytes = qint64(channelSize) * sizeof(SAMPLE_TYPE);
+	for(quint16 ch = 0; ch < channels; ch++) {
+		if(file.write(reinterpret_cast<const char *>(waveform[ch]), channelBytes) != channelBytes) {
+			file.cancelWriting();
+			return false;
+		}
+	}
+
+	return file.commit();
+}
+
+void
+WaveCache::evict(qint64 maxSize)
+{
+	// newest first
+	const QFileInfoList files = QDir(cacheDir()).entryInfoList(QStringList($("*.wfc")), QDir::Files, QDir::Time);
+	qint64 totalSize = 0;
+	for(const QFileInfo &fi: files) {
+		totalSize += fi.size();
+		if(totalSize > maxSize)
+			QFile::remove(fi.filePath());
+	}
+}
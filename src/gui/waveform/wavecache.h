@@ -0,0 +1,48 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef WAVECACHE_H
+#define WAVECACHE_H
+
+#include "gui/waveform/wavebuffer.h"
+
+#include <QString>
+
+namespace SubtitleComposer {
+/**
+ * @brief On-disk cache of decoded waveforms
+ *
+ * Cache files are keyed by media file path, size, modification time and audio stream index.
+ * Every use of a cache file refreshes its modification time, so eviction drops least recently
+ * used waveforms first.
+ */
+class WaveCache
+{
+public:
+	/**
+	 * @brief Cache file used for @p audioStream of @p mediaFile
+	 * @return empty string if @p mediaFile is not a local file
+	 */
+	static QString cacheFile(const QString &mediaFile, int audioStream);
+
+	/**
+	 * @brief Load waveform from @p cacheFile
+	 * @param waveform receives newly allocated channel buffers on success
+	 */
+	static bool load(const QString &cacheFile, quint32 *duration, quint32 *sampleRate, quint16 *channels, quint32 *channelSize, SAMPLE_TYPE ***waveform);
+	static bool store(const QString &cacheFile, quint32 duration, quint32 sampleRate, quint16 channels, quint32 channelSize, const SAMPLE_TYPE * const *waveform);
+
+	/**
+	 * @brief Remove least recently used cache files until they take no more than @p maxSize bytes
+	 */
+	static void evict(qint64 maxSize);
+
+private:
+	static QString cacheDir();
+};
+}
+
+#endif // WAVECACHE_H
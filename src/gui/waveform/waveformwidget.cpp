@@ -36,6 +36,8 @@
 
 #include <KLocalizedString>
 
+#include <algorithm>
+
 using namespace SubtitleComposer;
 
 #define ZOOM_MIN (1 << 3)
@@ -74,7 +76,7 @@ WaveformWidget::WaveformWidget(QWidget *parent)
 	m_waveformGraphics->installEventFilter(this);
 	m_widgetLayout->addWidget(m_waveformGraphics);
 
-	connect(m_wfBuffer->zoomBuffer(), &ZoomBuffer::zoomedBufferReady, m_waveformGraphics, QOverload<>::of(&QWidget::update));
+	connect(m_wfBuffer->zoomBuffer(), &ZoomBuffer::zoomedBufferReady, m_waveformGraphics, &WaveRenderer::invalidateWaveform);
 
 	m_scrollBar = new QScrollBar(Qt::Vertical, this);
 	m_scrollBar->setPageStep(windowSize());
@@ -232,7 +234,7 @@ WaveformWidget::handleTimeUpdate(quint32 msSpan)
 	}
 
 	m_visibleLinesDirty = true;
-	m_waveformGraphics->update();
+	m_waveformGraphics->invalidateWaveform();
 }
 
 void
@@ -358,6 +360,7 @@ WaveformWidget::clearAudioStream()
 	delete[] m_zoomData;
 	m_zoomData = nullptr;
 	m_zoomDataLen = 0;
+	m_waveformGraphics->invalidateWaveform();
 }
 
 void
@@ -381,28 +384,37 @@ WaveformWidget::updateVisibleLines()
 		}
 	}
 
+	// line could've been removed or subtitle replaced while dragging
+	if(m_draggedLine && m_draggedLine->line()->subtitle() != m_subtitle.data()) {
+		delete m_draggedLine;
+		m_draggedLine = nullptr;
+	}
+
 	it = m_visibleLines.begin();
-	for(int i = 0, n = m_subtitle->count(); i < n; i++) {
-		SubtitleLine *sub = m_subtitle->at(i);
-		const bool isDragged = m_draggedLine != nullptr && sub == m_draggedLine->line();
-		if(!sub->intersectsTimespan(m_timeStart, m_timeEnd) && !isDragged)
+	const QVector<SubtitleLine *> lines = m_subtitle->linesInTimespan(m_timeStart, m_timeEnd);
+	for(SubtitleLine *sub: lines) {
+		if(m_draggedLine && sub == m_draggedLine->line())
 			continue;
-		const Time showTime = isDragged ? m_draggedLine->showTime() : sub->showTime();
+		const Time showTime = sub->showTime();
 		while(it != m_visibleLines.end() && (*it)->showTime() < showTime) {
 			if((*it)->line() == sub)
 				break;
 			++it;
 		}
 		if(it == m_visibleLines.end() || (*it)->line() != sub) {
-			if(isDragged) {
-				m_visibleLines.emplace(it, m_draggedLine);
-				it = m_visibleLines.begin();
-			} else {
-				it = m_visibleLines.emplace(it, new WaveSubtitle(sub, m_waveformGraphics));
-				++it;
-			}
+			it = m_visibleLines.emplace(it, new WaveSubtitle(sub, m_waveformGraphics));
+			++it;
 		}
 	}
+
+	// dragged line is always visible, even when dragged out of view
+	if(m_draggedLine) {
+		const Time showTime = m_draggedLine->showTime();
+		it = std::find_if(m_visibleLines.begin(), m_visibleLines.end(), [&](const WaveSubtitle *ws){
+			return showTime <= ws->showTime();
+		});
+		m_visibleLines.emplace(it, m_draggedLine);
+	}
 }
 
 void
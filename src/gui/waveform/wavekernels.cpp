@@ -0,0 +1,230 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "wavekernels.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WAVEKERNELS_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(WAVEKERNELS_SSE2) && defined(Q_PROCESSOR_X86) && defined(Q_CC_GNU)
+#define WAVEKERNELS_AVX2
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+
+using namespace SubtitleComposer;
+
+static const quint32 BlockSize = 1U << WaveKernels::BlockShift;
+static_assert(BlockSize == 4, "vectorized kernels expect 4 sample blocks");
+
+static void
+reduceBlocksScalar(const qint16 *samples, quint32 blockCount, WavePeak *out)
+{
+	for(const WavePeak *end = out + blockCount; out != end; out++) {
+		quint32 sum = 0;
+		quint32 max = 0;
+		for(quint32 i = 0; i < BlockSize; i++) {
+			const quint32 val = WaveKernels::sampleValue(*samples++);
+			sum += val;
+			if(max < val)
+				max = val;
+		}
+		out->avg = sum >> WaveKernels::BlockShift;
+		out->max = max;
+	}
+}
+
+static void
+reduceRangeScalar(const qint16 *samples, quint32 count, quint64 *sum, quint32 *max)
+{
+	quint64 s = 0;
+	quint32 m = *max;
+	for(const qint16 *end = samples + count; samples != end; samples++) {
+		const quint32 val = WaveKernels::sampleValue(*samples);
+		s += val;
+		if(m < val)
+			m = val;
+	}
+	*sum += s;
+	*max = m;
+}
+
+#ifdef WAVEKERNELS_SSE2
+// |sample + 1| as unsigned 16 bit values (fits since the largest one is 32768)
+static inline __m128i
+absSSE2(const qint16 *samples)
+{
+	const __m128i v = _mm_add_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(samples)), _mm_set1_epi16(1));
+	const __m128i neg = _mm_srai_epi16(v, 15);
+	return _mm_sub_epi16(_mm_xor_si128(v, neg), neg);
+}
+
+static void
+reduceBlocksSSE2(const qint16 *samples, quint32 blockCount, WavePeak *out)
+{
+	const __m128i lo16 = _mm_set1_epi32(0xFFFF);
+	const __m128i flip = _mm_set1_epi16(qint16(0x8000));
+
+	for(; blockCount >= 2; blockCount -= 2, samples += 2 * BlockSize, out += 2) {
+		const __m128i v = absSSE2(samples);
+
+		// sum of each block ends up in 32bit lanes 0 and 2
+		__m128i sum = _mm_add_epi32(_mm_and_si128(v, lo16), _mm_srli_epi32(v, 16));
+		sum = _mm_add_epi32(sum, _mm_srli_epi64(sum, 32));
+
+		// flip sign bit so signed compare orders unsigned values, peaks end up in 16bit lanes 0 and 4
+		__m128i peak = _mm_xor_si128(v, flip);
+		peak = _mm_max_epi16(peak, _mm_srli_epi32(peak, 16));
+		peak = _mm_max_epi16(peak, _mm_srli_epi64(peak, 32));
+
+		out[0].avg = quint32(_mm_cvtsi128_si32(sum)) >> WaveKernels::BlockShift;
+		out[1].avg = quint32(_mm_cvtsi128_si32(_mm_srli_si128(sum, 8))) >> WaveKernels::BlockShift;
+		out[0].max = _mm_extract_epi16(peak, 0) ^ 0x8000;
+		out[1].max = _mm_extract_epi16(peak, 4) ^ 0x8000;
+	}
+
+	reduceBlocksScalar(samples, blockCount, out);
+}
+
+static void
+reduceRangeSSE2(const qint16 *samples, quint32 count, quint64 *sum, quint32 *max)
+{
+	const __m128i lo16 = _mm_set1_epi32(0xFFFF);
+	const __m128i flip = _mm_set1_epi16(qint16(0x8000));
+	alignas(16) quint32 sums[4];
+
+	__m128i peak = flip;
+	while(count >= 8) {
+		// each iteration adds at most 2 * 32768 to 32bit lanes - flush them before they can overflow
+		const quint32 n = qMin(count >> 3, 32768U);
+		__m128i acc = _mm_setzero_si128();
+		for(const qint16 *end = samples + (n << 3); samples != end; samples += 8) {
+			const __m128i v = absSSE2(samples);
+			acc = _mm_add_epi32(acc, _mm_add_epi32(_mm_and_si128(v, lo16), _mm_srli_epi32(v, 16)));
+			peak = _mm_max_epi16(peak, _mm_xor_si128(v, flip));
+		}
+		count -= n << 3;
+
+		// lanes are summed as 64bit - their total can overflow 32bits
+		_mm_store_si128(reinterpret_cast<__m128i *>(sums), acc);
+		*sum += quint64(sums[0]) + sums[1] + sums[2] + sums[3];
+	}
+
+	peak = _mm_max_epi16(peak, _mm_shuffle_epi32(peak, _MM_SHUFFLE(1, 0, 3, 2)));
+	peak = _mm_max_epi16(peak, _mm_shuffle_epi32(peak, _MM_SHUFFLE(2, 3, 0, 1)));
+	peak = _mm_max_epi16(peak, _mm_shufflelo_epi16(peak, _MM_SHUFFLE(2, 3, 0, 1)));
+	const quint32 m = _mm_extract_epi16(peak, 0) ^ 0x8000;
+	if(*max < m)
+		*max = m;
+
+	reduceRangeScalar(samples, count, sum, max);
+}
+#endif
+
+#ifdef WAVEKERNELS_AVX2
+TARGET_AVX2 static inline __m256i
+absAVX2(const qint16 *samples)
+{
+	// abs of -32768 stays 0x8000 which is right when read as unsigned
+	return _mm256_abs_epi16(_mm256_add_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(samples)), _mm256_set1_epi16(1)));
+}
+
+TARGET_AVX2 static void
+reduceBlocksAVX2(const qint16 *samples, quint32 blockCount, WavePeak *out)
+{
+	const __m256i lo16 = _mm256_set1_epi32(0xFFFF);
+	const __m256i flip = _mm256_set1_epi16(qint16(0x8000));
+	alignas(32) quint32 sums[8];
+	alignas(32) quint16 peaks[16];
+
+	for(; blockCount >= 4; blockCount -= 4, samples += 4 * BlockSize, out += 4) {
+		const __m256i v = absAVX2(samples);
+
+		__m256i sum = _mm256_add_epi32(_mm256_and_si256(v, lo16), _mm256_srli_epi32(v, 16));
+		sum = _mm256_add_epi32(sum, _mm256_srli_epi64(sum, 32));
+
+		__m256i peak = _mm256_xor_si256(v, flip);
+		peak = _mm256_max_epi16(peak, _mm256_srli_epi32(peak, 16));
+		peak = _mm256_max_epi16(peak, _mm256_srli_epi64(peak, 32));
+
+		_mm256_store_si256(reinterpret_cast<__m256i *>(sums), sum);
+		_mm256_store_si256(reinterpret_cast<__m256i *>(peaks), peak);
+		for(int i = 0; i < 4; i++) {
+			out[i].avg = sums[i << 1] >> WaveKernels::BlockShift;
+			out[i].max = peaks[i << 2] ^ 0x8000;
+		}
+	}
+
+	reduceBlocksSSE2(samples, blockCount, out);
+}
+
+TARGET_AVX2 static void
+reduceRangeAVX2(const qint16 *samples, quint32 count, quint64 *sum, quint32 *max)
+{
+	const __m256i lo16 = _mm256_set1_epi32(0xFFFF);
+	const __m256i flip = _mm256_set1_epi16(qint16(0x8000));
+	alignas(32) quint32 sums[8];
+	alignas(32) quint16 peaks[16];
+
+	__m256i peak = flip;
+	while(count >= 16) {
+		// each iteration adds at most 2 * 32768 to 32bit lanes - flush them before they can overflow
+		const quint32 n = qMin(count >> 4, 32768U);
+		__m256i acc = _mm256_setzero_si256();
+		for(const qint16 *end = samples + (n << 4); samples != end; samples += 16) {
+			const __m256i v = absAVX2(samples);
+			acc = _mm256_add_epi32(acc, _mm256_add_epi32(_mm256_and_si256(v, lo16), _mm256_srli_epi32(v, 16)));
+			peak = _mm256_max_epi16(peak, _mm256_xor_si256(v, flip));
+		}
+		count -= n << 4;
+
+		_mm256_store_si256(reinterpret_cast<__m256i *>(sums), acc);
+		for(int i = 0; i < 8; i++)
+			*sum += sums[i];
+	}
+
+	_mm256_store_si256(reinterpret_cast<__m256i *>(peaks), peak);
+	for(int i = 0; i < 16; i++) {
+		const quint32 m = peaks[i] ^ 0x8000;
+		if(*max < m)
+			*max = m;
+	}
+
+	reduceRangeSSE2(samples, count, sum, max);
+}
+#endif
+
+static const WaveKernels kernelsScalar = { "scalar", reduceBlocksScalar, reduceRangeScalar };
+#ifdef WAVEKERNELS_SSE2
+static const WaveKernels kernelsSSE2 = { "sse2", reduceBlocksSSE2, reduceRangeSSE2 };
+#endif
+#ifdef WAVEKERNELS_AVX2
+static const WaveKernels kernelsAVX2 = { "avx2", reduceBlocksAVX2, reduceRangeAVX2 };
+#endif
+
+QVector<const WaveKernels *>
+WaveKernels::available()
+{
+	QVector<const WaveKernels *> kernels;
+	kernels.push_back(&kernelsScalar);
+#ifdef WAVEKERNELS_SSE2
+	kernels.push_back(&kernelsSSE2);
+#endif
+#ifdef WAVEKERNELS_AVX2
+	if(__builtin_cpu_supports("avx2"))
+		kernels.push_back(&kernelsAVX2);
+#endif
+	return kernels;
+}
+
+const WaveKernels &
+WaveKernels::best()
+{
+	static const WaveKernels *kernels = available().constLast();
+	return *kernels;
+}
@@ -0,0 +1,53 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef WAVEKERNELS_H
+#define WAVEKERNELS_H
+
+#include <QtGlobal>
+#include <QVector>
+
+namespace SubtitleComposer {
+struct WavePeak {
+	quint16 avg;
+	quint16 max;
+};
+
+/**
+ * @brief Reduction kernels over 16 bit waveform samples
+ *
+ * Sample values are taken as distance from the middle of sample range, same as waveform is drawn.
+ * Vectorized versions are selected at runtime depending on what the CPU supports.
+ */
+struct WaveKernels {
+	// number of samples reduced into each block by reduceBlocks() is 2^BlockShift
+	static const quint8 BlockShift = 2;
+
+	const char *name;
+
+	/**
+	 * @brief Store average and peak of every block of 2^BlockShift samples into @p out
+	 */
+	void (*reduceBlocks)(const qint16 *samples, quint32 blockCount, WavePeak *out);
+	/**
+	 * @brief Add absolute values of @p count samples to @p sum and raise @p max to their peak
+	 */
+	void (*reduceRange)(const qint16 *samples, quint32 count, quint64 *sum, quint32 *max);
+
+	static inline quint32 sampleValue(qint16 sample) { return qAbs(qint32(sample) + 1); }
+
+	/**
+	 * @brief Fastest kernels supported by the running CPU
+	 */
+	static const WaveKernels & best();
+	/**
+	 * @brief All kernels supported by the running CPU, starting with scalar ones
+	 */
+	static QVector<const WaveKernels *> available();
+};
+}
+
+#endif // WAVEKERNELS_H
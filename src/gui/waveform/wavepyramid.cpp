@@ -0,0 +1,172 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "wavepyramid.h"
+
+#include <type_traits>
+
+static_assert(std::is_same<SAMPLE_TYPE, qint16>::value, "waveform kernels work on 16 bit samples");
+
+using namespace SubtitleComposer;
+
+WavePyramid::WavePyramid()
+	: m_kernels(WaveKernels::best()),
+	  m_waveform(nullptr),
+	  m_channels(0),
+	  m_levelCount(0),
+	  m_levelSize(nullptr),
+	  m_levels(nullptr),
+	  m_reduced(0)
+{
+}
+
+WavePyramid::~WavePyramid()
+{
+	clear();
+}
+
+void
+WavePyramid::clear()
+{
+	m_reduced.storeRelease(0);
+
+	if(m_levels) {
+		for(quint16 ch = 0; ch < m_channels; ch++) {
+			for(quint8 l = 0; l < m_levelCount; l++)
+				delete[] m_levels[ch][l];
+			delete[] m_levels[ch];
+		}
+		delete[] m_levels;
+		m_levels = nullptr;
+	}
+	delete[] m_levelSize;
+	m_levelSize = nullptr;
+	m_levelCount = 0;
+	m_channels = 0;
+	m_waveform = nullptr;
+}
+
+void
+WavePyramid::reset(const SAMPLE_TYPE * const *waveform, quint16 channels, quint32 size)
+{
+	clear();
+
+	if(!waveform || !channels)
+		return;
+
+	m_waveform = waveform;
+	m_channels = channels;
+
+	while(size >> (BaseShift + m_levelCount))
+		m_levelCount++;
+	if(!m_levelCount)
+		return;
+
+	m_levelSize = new quint32[m_levelCount];
+	for(quint8 l = 0; l < m_levelCount; l++)
+		m_levelSize[l] = size >> (BaseShift + l);
+
+	m_levels = new WavePeak **[m_channels];
+	for(quint16 ch = 0; ch < m_channels; ch++) {
+		m_levels[ch] = new WavePeak *[m_levelCount];
+		for(quint8 l = 0; l < m_levelCount; l++)
+			m_levels[ch][l] = new WavePeak[m_levelSize[l]];
+	}
+}
+
+void
+WavePyramid::rewind(quint32 offset)
+{
+	if(offset < m_reduced.loadAcquire())
+		m_reduced.storeRelease(offset & ~((1U << BaseShift) - 1));
+}
+
+void
+WavePyramid::update(quint32 available)
+{
+	if(!m_levels)
+		return;
+
+	const quint32 reduced = m_reduced.loadAcquire();
+	if(available <= reduced)
+		return;
+
+	// base level is built from raw samples
+	quint32 from = reduced >> BaseShift;
+	quint32 to = qMin(available >> BaseShift, m_levelSize[0]);
+	if(to > from) {
+		for(quint16 ch = 0; ch < m_channels; ch++)
+			m_kernels.reduceBlocks(m_waveform[ch] + (from << BaseShift), to - from, m_levels[ch][0] + from);
+	}
+
+	// every other level is built from the one below
+	for(quint8 l = 1; l < m_levelCount; l++) {
+		from >>= 1;
+		to = qMin(to >> 1, m_levelSize[l]);
+		for(quint16 ch = 0; ch < m_channels; ch++) {
+			const WavePeak *src = m_levels[ch][l - 1];
+			WavePeak *dst = m_levels[ch][l];
+			for(quint32 b = from; b < to; b++) {
+				const WavePeak &p0 = src[b << 1];
+				const WavePeak &p1 = src[(b << 1) + 1];
+				dst[b].avg = (quint32(p0.avg) + p1.avg) >> 1;
+				dst[b].max = qMax(p0.max, p1.max);
+			}
+		}
+	}
+
+	m_reduced.storeRelease(qMin(available, m_levelSize[0] << BaseShift) & ~((1U << BaseShift) - 1));
+}
+
+void
+WavePyramid::reduce(quint16 channel, quint32 start, quint32 end, WaveZoomData *out) const
+{
+	Q_ASSERT(start < end);
+
+	const SAMPLE_TYPE *raw = m_waveform ? m_waveform[channel] : nullptr;
+	const quint32 count = end - start;
+	quint64 sum = 0;
+	quint32 max = 0;
+
+	const auto addBlock = [&](quint8 level, quint32 block){
+		const WavePeak &p = m_levels[channel][level][block];
+		sum += quint64(p.avg) << (BaseShift + level);
+		if(max < p.max)
+			max = p.max;
+	};
+
+	// samples before first block and the ones that are not reduced yet are read directly
+	const quint32 baseMask = (1U << BaseShift) - 1;
+	const quint32 reduced = m_levels ? m_reduced.loadAcquire() : 0;
+	const quint32 blockStart = qMin((start + baseMask) & ~baseMask, end);
+	const quint32 blockEnd = qMax(qMin(end, reduced) & ~baseMask, blockStart);
+	if(start < blockStart)
+		m_kernels.reduceRange(raw + start, blockStart - start, &sum, &max);
+	if(blockEnd < end)
+		m_kernels.reduceRange(raw + blockEnd, end - blockEnd, &sum, &max);
+	start = blockStart;
+	end = blockEnd;
+
+	// walk up the pyramid taking largest aligned blocks
+	quint32 i = start >> BaseShift;
+	quint32 j = end >> BaseShift;
+	for(quint8 l = 0; i < j; l++) {
+		if(l + 1 == m_levelCount) {
+			while(i < j)
+				addBlock(l, i++);
+			break;
+		}
+		if(i & 1)
+			addBlock(l, i++);
+		if(j & 1)
+			addBlock(l, --j);
+		i >>= 1;
+		j >>= 1;
+	}
+
+	out->min = sum / count;
+	out->max = max;
+}
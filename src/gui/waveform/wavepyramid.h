@@ -0,0 +1,63 @@
+/*
+    SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef WAVEPYRAMID_H
+#define WAVEPYRAMID_H
+
+#include "gui/waveform/wavebuffer.h"
+#include "gui/waveform/wavekernels.h"
+
+#include <QAtomicInteger>
+
+namespace SubtitleComposer {
+/**
+ * @brief Power-of-two average/peak pyramid over the decoded waveform
+ *
+ * Level k holds one entry for every 2^k samples. Levels are built incrementally while audio
+ * is decoded, so any zoom scale can be answered with O(log samplesPerPixel) lookups per pixel
+ * instead of rescanning raw samples.
+ */
+class WavePyramid
+{
+public:
+	WavePyramid();
+	~WavePyramid();
+
+	void reset(const SAMPLE_TYPE * const *waveform, quint16 channels, quint32 size);
+	void clear();
+
+	/**
+	 * @brief Reduce all complete blocks among first @p available samples
+	 */
+	void update(quint32 available);
+	/**
+	 * @brief Invalidate blocks that include samples from @p offset onwards (they were overwritten)
+	 */
+	void rewind(quint32 offset);
+
+	inline quint32 samplesReduced() const { return m_reduced.loadAcquire(); }
+
+	/**
+	 * @brief Average and peak of absolute sample values in range [start, end)
+	 */
+	void reduce(quint16 channel, quint32 start, quint32 end, WaveZoomData *out) const;
+
+private:
+	// smallest blocks are 4 samples - keeps pyramid memory at half of raw waveform
+	static const quint8 BaseShift = WaveKernels::BlockShift;
+
+	const WaveKernels &m_kernels;
+	const SAMPLE_TYPE * const *m_waveform;
+	quint16 m_channels;
+	quint8 m_levelCount;
+	quint32 *m_levelSize;
+	WavePeak ***m_levels; // [channel][level - BaseShift][block]
+
+	QAtomicInteger<quint32> m_reduced;
+};
+}
+
+#endif // WAVEPYRAMID_H
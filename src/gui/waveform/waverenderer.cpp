@@ -10,6 +10,7 @@
 #include "application.h"
 #include "scconfig.h"
 #include "core/richtext/richdocument.h"
+#include "core/subtitleline.h"
 #include "gui/waveform/wavebuffer.h"
 #include "gui/waveform/waveformwidget.h"
 #include "gui/waveform/wavesubtitle.h"
@@ -22,10 +23,13 @@
 
 using namespace SubtitleComposer;
 
+// label cache cost is in KiB of image data
+static const int LabelCacheSize = 16 * 1024;
 
 WaveRenderer::WaveRenderer(WaveformWidget *parent)
 	: QWidget(parent),
-	  m_wfw(parent)
+	  m_wfw(parent),
+	  m_labelCache(LabelCacheSize)
 {
 	setAttribute(Qt::WA_NoSystemBackground, true);
 	setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
@@ -41,21 +45,42 @@ WaveRenderer::showTranslation() const
 	return m_wfw->m_showTranslation;
 }
 
+WaveLabelKey
+WaveRenderer::labelKey(const SubtitleLine *line) const
+{
+	// text revision doesn't need the document, it's created only when label gets rendered
+	const bool translation = showTranslation();
+	return WaveLabelKey{line, line->textRevision(!translation), m_fontTextKey, translation};
+}
+
+QImage
+WaveRenderer::cachedLabel(const WaveLabelKey &key) const
+{
+	const QImage *image = m_labelCache.object(key);
+	return image ? *image : QImage();
+}
+
+void
+WaveRenderer::cacheLabel(const WaveLabelKey &key, const QImage &image)
+{
+	m_labelCache.insert(key, new QImage(image), qMax(1, image.bytesPerLine() * image.height() / 1024));
+}
+
 void
 WaveRenderer::onConfigChanged()
 {
 	m_fontNumber = QFont(SCConfig::wfFontFamily(), SCConfig::wfSubNumberFontSize());
 	m_fontNumberHeight = QFontMetrics(m_fontNumber).height();
 	m_fontText = QFont(SCConfig::wfFontFamily(), SCConfig::wfSubTextFontSize());
+	m_fontTextKey = m_fontText.key();
 
 	m_subBorderWidth = SCConfig::wfSubBorderWidth();
 
 	m_subNumberColor = QPen(QColor(SCConfig::wfSubNumberColor()), 0, Qt::SolidLine);
 	m_subTextColor = QPen(QColor(SCConfig::wfSubTextColor()), 0, Qt::SolidLine);
 
-	// FIXME: instead of using devicePixelRatioF() for pen width we should draw waveform in higher resolution
-	m_waveInner = QPen(QColor(SCConfig::wfInnerColor()), devicePixelRatioF(), Qt::SolidLine);
-	m_waveOuter = QPen(QColor(SCConfig::wfOuterColor()), devicePixelRatioF(), Qt::SolidLine);
+	m_waveInner = QColor(SCConfig::wfInnerColor());
+	m_waveOuter = QColor(SCConfig::wfOuterColor());
 
 	m_subtitleBack = QColor(SCConfig::wfSubBackground());
 	m_subtitleBorder = QColor(SCConfig::wfSubBorder());
@@ -65,6 +90,18 @@ WaveRenderer::onConfigChanged()
 
 	m_playColor = QPen(QColor(SCConfig::wfPlayLocation()), 0, Qt::SolidLine);
 	m_mouseColor = QPen(QColor(SCConfig::wfMouseLocation()), 0, Qt::DotLine);
+
+	// text color is not part of label key
+	m_labelCache.clear();
+
+	invalidateWaveform();
+}
+
+void
+WaveRenderer::invalidateWaveform()
+{
+	m_waveImageDirty = true;
+	update();
 }
 
 bool
@@ -132,35 +169,67 @@ WaveRenderer::event(QEvent *evt)
 	return QWidget::event(evt);
 }
 
+static inline void
+fillSpan(QRgb *center, qsizetype step, qint32 halfWidth, QRgb color)
+{
+	for(QRgb *px = center - halfWidth * step, *end = center + (halfWidth + 1) * step; px != end; px += step)
+		*px = color;
+}
+
 void
-WaveRenderer::paintWaveform(QPainter &painter, quint32 widgetWidth, quint32 widgetHeight)
+WaveRenderer::renderWaveform(const QSize &size, qreal pixelRatio)
 {
+	if(m_waveImage.size() != size)
+		m_waveImage = QImage(size, QImage::Format_RGB32);
+	m_waveImage.setDevicePixelRatio(pixelRatio);
+	m_waveImage.fill(Qt::black);
+	m_waveImageDirty = false;
+
 	const quint16 chans = m_wfw->m_wfBuffer->channels();
-	if(!chans || !m_wfw->m_zoomDataLen)
+	const quint32 dataLen = m_wfw->m_zoomDataLen;
+	if(!chans || !dataLen)
 		return;
 
-	const quint32 chHalfWidth = (m_vertical ? widgetWidth : widgetHeight) / chans / 2;
+	// zoom data has one entry per logical pixel, image is drawn in device pixels
+	const quint32 timeSpan = m_vertical ? size.height() : size.width();
+	const qint32 chHalfWidth = (m_vertical ? size.width() : size.height()) / chans / 2;
+	if(chHalfWidth <= 0)
+		return;
+
+	QRgb *bits = reinterpret_cast<QRgb *>(m_waveImage.bits());
+	const qsizetype stride = m_waveImage.bytesPerLine() / sizeof(QRgb);
+	const qsizetype timeStep = m_vertical ? stride : 1;
+	const qsizetype ampStep = m_vertical ? 1 : stride;
+	const QRgb outer = m_waveOuter.rgb();
+	const QRgb inner = m_waveInner.rgb();
 
 	for(quint16 ch = 0; ch < chans; ch++) {
 		const qint32 chCenter = (ch * 2 + 1) * chHalfWidth;
-		for(quint32 y = 0; y < m_wfw->m_zoomDataLen; y++) {
-			const qint32 xMin = m_wfw->m_zoomData[ch][y].min * chHalfWidth / SAMPLE_MAX;
-			const qint32 xMax = m_wfw->m_zoomData[ch][y].max * chHalfWidth / SAMPLE_MAX;
-
-			painter.setPen(m_waveOuter);
-			if(m_vertical)
-				painter.drawLine(chCenter - xMax, y, chCenter + xMax, y);
-			else
-				painter.drawLine(y, chCenter - xMax, y, chCenter + xMax);
-			painter.setPen(m_waveInner);
-			if(m_vertical)
-				painter.drawLine(chCenter - xMin, y, chCenter + xMin, y);
-			else
-				painter.drawLine(y, chCenter - xMin, y, chCenter + xMin);
+		const WaveZoomData *data = m_wfw->m_zoomData[ch];
+		for(quint32 t = 0; t < timeSpan; t++) {
+			const quint32 i = t / pixelRatio;
+			if(i >= dataLen)
+				break;
+			const qint32 xMax = qMin<qint32>(data[i].max * chHalfWidth / SAMPLE_MAX, chHalfWidth - 1);
+			const qint32 xMin = qMin<qint32>(data[i].min * chHalfWidth / SAMPLE_MAX, xMax);
+			QRgb *center = bits + t * timeStep + chCenter * ampStep;
+			fillSpan(center, ampStep, xMax, outer);
+			fillSpan(center, ampStep, xMin, inner);
 		}
 	}
 }
 
+void
+WaveRenderer::paintWaveform(QPainter &painter, quint32 widgetWidth, quint32 widgetHeight)
+{
+	const qreal pixelRatio = devicePixelRatioF();
+	const QSize size(qRound(widgetWidth * pixelRatio), qRound(widgetHeight * pixelRatio));
+	if(m_waveImageDirty || m_waveImage.size() != size || m_waveImage.devicePixelRatio() != pixelRatio)
+		renderWaveform(size, pixelRatio);
+
+	painter.drawImage(0, 0, m_waveImage);
+}
+
 void
 WaveRenderer::paintGraphics(QPainter &painter)
 {
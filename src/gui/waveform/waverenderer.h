@@ -10,14 +10,36 @@
 #include "core/time.h"
 
 #include <QWidget>
+#include <QCache>
 #include <QPen>
 #include <QColor>
 #include <QFont>
+#include <QImage>
 
 namespace SubtitleComposer {
 class RichDocument;
+class SubtitleLine;
 class WaveformWidget;
 
+struct WaveLabelKey {
+	const SubtitleLine *line;
+	quint64 revision;
+	QString font;
+	bool translation;
+
+	inline bool operator==(const WaveLabelKey &other) const {
+		return line == other.line && revision == other.revision && translation == other.translation && font == other.font;
+	}
+	inline bool operator!=(const WaveLabelKey &other) const { return !operator==(other); }
+};
+
+inline uint
+qHash(const WaveLabelKey &key, uint seed = 0)
+{
+	// text revisions are unique among lines, font and translation mode rarely differ between entries
+	return qHash(key.revision, seed) ^ qHash(quintptr(key.line), seed);
+}
+
 class WaveRenderer : public QWidget
 {
 	Q_OBJECT
@@ -33,11 +55,28 @@ public:
 
 	bool showTranslation() const;
 
+	/**
+	 * @brief Key of subtitle label image for @p line as it would be rendered with current settings
+	 */
+	WaveLabelKey labelKey(const SubtitleLine *line) const;
+	/**
+	 * @brief Rendered subtitle label image, kept across WaveSubtitle instances
+	 * @return null image when label is not cached
+	 */
+	QImage cachedLabel(const WaveLabelKey &key) const;
+	void cacheLabel(const WaveLabelKey &key, const QImage &image);
+
+	/**
+	 * @brief Schedules repaint with waveform image rendered again from zoom data
+	 */
+	void invalidateWaveform();
+
 private:
 	bool event(QEvent *evt) override;
 
 	void paintGraphics(QPainter &painter);
 	void paintWaveform(QPainter &painter, quint32 widgetWidth, quint32 widgetHeight);
+	void renderWaveform(const QSize &size, qreal pixelRatio);
 
 	void onConfigChanged();
 
@@ -49,14 +88,15 @@ private:
 	QFont m_fontNumber;
 	int m_fontNumberHeight;
 	QFont m_fontText;
+	QString m_fontTextKey;
 
 	int m_subBorderWidth;
 
 	QPen m_subNumberColor;
 	QPen m_subTextColor;
 
-	QPen m_waveInner;
-	QPen m_waveOuter;
+	QColor m_waveInner;
+	QColor m_waveOuter;
 
 	QColor m_subtitleBack;
 	QColor m_subtitleBorder;
@@ -66,6 +106,13 @@ private:
 
 	QPen m_playColor;
 	QPen m_mouseColor;
+
+	// waveform is rendered only when zoom data changes, cursors and subtitles are painted over it
+	QImage m_waveImage;
+	bool m_waveImageDirty = true;
+
+	// labels of lines that scroll out of view are kept, so they are not laid out again when they come back
+	mutable QCache<WaveLabelKey, QImage> m_labelCache;
 };
 }
 
@@ -22,10 +22,9 @@ WaveSubtitle::WaveSubtitle(SubtitleLine *line, WaveRenderer *parent)
 	: QObject(parent),
 	  m_line(line),
 	  m_rend(parent),
-	  m_image(1, 1, QImage::Format_ARGB32_Premultiplied)
+	  m_image(1, 1, QImage::Format_ARGB32_Premultiplied),
+	  m_imageKey{nullptr, 0, QString(), false}
 {
-	const RichDocument *doc = m_rend->showTranslation() ? m_line->secondaryDoc() : m_line->primaryDoc();
-	connect(doc, &RichDocument::contentsChanged, this, [&](){ m_imageDirty = true; });
 }
 
 WaveSubtitle::~WaveSubtitle()
@@ -133,10 +132,16 @@ WaveSubtitle::hideTime() const
 const QImage &
 WaveSubtitle::image() const
 {
-	if(!m_imageDirty)
+	const WaveLabelKey key = m_rend->labelKey(m_line);
+	if(key == m_imageKey)
 		return m_image;
 
-	const RichDocument *doc = m_rend->showTranslation() ? m_line->secondaryDoc() : m_line->primaryDoc();
+	m_imageKey = key;
+	m_image = m_rend->cachedLabel(key);
+	if(!m_image.isNull())
+		return m_image;
+
+	const RichDocument *doc = key.translation ? m_line->secondaryDoc() : m_line->primaryDoc();
 	const RichDocumentLayout *layout = doc->documentLayout();
 
 	qreal width = 0., height = 0.;
@@ -188,6 +193,6 @@ WaveSubtitle::image() const
 
 	painter->end();
 
-	m_imageDirty = false;
+	m_rend->cacheLabel(key, m_image);
 	return m_image;
 }
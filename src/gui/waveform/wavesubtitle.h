@@ -8,6 +8,7 @@
 #define WAVESUBTITLE_H
 
 #include <core/time.h>
+#include "gui/waveform/waverenderer.h"
 
 #include <QImage>
 #include <QObject>
@@ -54,7 +55,7 @@ private:
 	WaveRenderer *m_rend;
 
 	mutable QImage m_image;
-	mutable bool m_imageDirty = true;
+	mutable WaveLabelKey m_imageKey;
 
 	DragPosition m_dragMode = DRAG_NONE;
 	double m_dragTime = 0.;
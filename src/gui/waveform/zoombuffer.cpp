@@ -6,6 +6,9 @@
 
 #include "zoombuffer.h"
 
+#include "gui/waveform/wavepyramid.h"
+
+#include <limits>
 #include <list>
 
 struct DataRange {
@@ -22,7 +25,9 @@ ZoomBuffer::ZoomBuffer(WaveBuffer *parent)
 	  m_samplesPerPixel(0),
 	  m_waveformZoomed(nullptr),
 	  m_waveformZoomedSize(0),
-	  m_waveform(nullptr)
+	  m_waveform(nullptr),
+	  m_invalidStart(std::numeric_limits<quint32>::max()),
+	  m_invalidEnd(0)
 {
 }
 
@@ -62,6 +67,12 @@ ZoomBuffer::start()
 		m_waveformZoomed[i] = new WaveZoomData[m_waveformZoomedSize];
 	emit zoomedBufferReady();
 
+	{ // everything is zoomed from scratch
+		QMutexLocker l(&m_invalidMutex);
+		m_invalidStart = std::numeric_limits<quint32>::max();
+		m_invalidEnd = 0;
+	}
+
 	QThread::start();
 }
 
@@ -78,10 +89,26 @@ ZoomBuffer::run()
 	RangeList ranges;
 	quint32 lastProcessed = 0;
 	RangeList::iterator range = ranges.end();
+	// requeue pixels that were already processed from samples overwritten since
+	const auto queueInvalidated = [&](){
+		QMutexLocker l(&m_invalidMutex);
+		if(m_invalidStart >= m_invalidEnd)
+			return false;
+		const quint32 start = m_invalidStart / m_samplesPerPixel;
+		const quint32 end = qMin((m_invalidEnd + m_samplesPerPixel - 1) / m_samplesPerPixel, lastProcessed);
+		m_invalidStart = std::numeric_limits<quint32>::max();
+		m_invalidEnd = 0;
+		if(start >= end)
+			return false;
+		ranges.push_back(DataRange{start, end});
+		return true;
+	};
 	for(;;) {
 		// wait for more samples if there aren't any
 		if(ranges.empty()) {
 			while(!isInterruptionRequested()) {
+				if(queueInvalidated())
+					break;
 				const bool decoding = m_waveBuffer->isDecoding();
 				const quint32 lastAvailable = m_waveBuffer->samplesAvailable() / m_samplesPerPixel;
 				if(lastProcessed != lastAvailable) {
@@ -92,6 +119,8 @@ ZoomBuffer::run()
 					break;
 				msleep(100);
 			}
+		} else {
+			queueInvalidated();
 		}
 
 		// process requested range
@@ -146,12 +175,19 @@ ZoomBuffer::run()
 
 		Q_ASSERT(range != ranges.end());
 
+		// pixels below lastProcessed were zoomed already and might be shown
+		const bool reprocessed = range->end <= lastProcessed;
+
 		updateZoomRange(&range->start, range->end);
-		lastProcessed = range->start;
+		// ranges can be processed out of order, everything below is done once they are empty
+		lastProcessed = qMax(lastProcessed, range->start);
 
 		// whole range was processed
-		if(range->start == range->end)
+		if(range->start == range->end) {
 			range = ranges.erase(range);
+			if(reprocessed)
+				emit zoomedBufferReady();
+		}
 	}
 }
 
@@ -161,25 +197,13 @@ ZoomBuffer::updateZoomRange(quint32 *start, quint32 end)
 	Q_ASSERT(end <= m_waveformZoomedSize);
 
 	const quint16 channels = m_waveBuffer->channels();
+	const WavePyramid *pyramid = m_waveBuffer->pyramid();
 
 	while(*start < end) {
-		quint32 i = *start * m_samplesPerPixel;
+		const quint32 i = *start * m_samplesPerPixel;
 
-		for(quint16 ch = 0; ch < channels; ch++) {
-			const quint32 val = qAbs(qint32(m_waveform[ch][i]) - SAMPLE_MIN - (SAMPLE_MAX - SAMPLE_MIN) / 2);
-			m_waveformZoomed[ch][*start].min = val / m_samplesPerPixel;
-			m_waveformZoomed[ch][*start].max = val;
-		}
-
-		const quint32 iEnd = i + m_samplesPerPixel;
-		while(++i < iEnd) {
-			for(quint16 ch = 0; ch < channels; ch++) {
-				const quint32 val = qAbs(qint32(m_waveform[ch][i]) - SAMPLE_MIN - (SAMPLE_MAX - SAMPLE_MIN) / 2);
-				m_waveformZoomed[ch][*start].min += val / m_samplesPerPixel;
-				if(m_waveformZoomed[ch][*start].max < val)
-					m_waveformZoomed[ch][*start].max = val;
-			}
-		}
+		for(quint16 ch = 0; ch < channels; ch++)
+			pyramid->reduce(ch, i, i + m_samplesPerPixel, &m_waveformZoomed[ch][*start]);
 
 		(*start)++;
 
@@ -240,3 +264,14 @@ ZoomBuffer::zoomedBuffer(quint32 timeStart, quint32 timeEnd, WaveZoomData **buff
 		m_restartProcessing = true;
 	}
 }
+
+void
+ZoomBuffer::invalidate(quint32 sampleStart, quint32 sampleEnd)
+{
+	if(sampleStart >= sampleEnd)
+		return;
+
+	QMutexLocker l(&m_invalidMutex);
+	m_invalidStart = qMin(m_invalidStart, sampleStart);
+	m_invalidEnd = qMax(m_invalidEnd, sampleEnd);
+}
@@ -25,6 +25,12 @@ public:
 	void setWaveform(const SAMPLE_TYPE * const *waveform);
 	void setZoomScale(quint32 samplesPerPixel);
 	void zoomedBuffer(quint32 timeStart, quint32 timeEnd, WaveZoomData **buffers, quint32 *bufLen);
+	/**
+	 * @brief Marks samples that were overwritten after they became available so they get zoomed again
+	 * @param sampleStart first overwritten sample
+	 * @param sampleEnd sample after the last overwritten one
+	 */
+	void invalidate(quint32 sampleStart, quint32 sampleEnd);
 
 	inline quint32 samplesPerPixel() const { return m_samplesPerPixel; }
 
@@ -53,6 +59,10 @@ private:
 	quint32 m_reqStart = 0;
 	quint32 m_reqEnd = 0;
 	quint32 *m_reqLen = nullptr;
+
+	QMutex m_invalidMutex;
+	quint32 m_invalidStart;
+	quint32 m_invalidEnd;
 };
 }
 
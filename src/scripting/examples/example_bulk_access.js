@@ -0,0 +1,29 @@
+/*
+	SPDX-FileCopyrightText: 2010-2022 Mladen Milinkovic <max@smoothware.net>
+
+	SPDX-License-Identifier: GPL-2.0-or-later
+
+	@category Examples
+	@name Bulk Line Access
+	@version 1.0
+	@summary Example script to trim spaces and delay all lines by one second using bulk accessors.
+	@author SubtitleComposer Team
+*/
+
+let s = subtitle.instance();
+
+// texts and times of all lines are read into plain arrays at once,
+// rich texts keep the styling when they are written back
+let texts = s.richTexts(0, -1, subtitle.Primary);
+let showTimes = s.showTimes();
+let hideTimes = s.hideTimes();
+
+for(let i = 0; i < texts.length; i++) {
+	texts[i] = texts[i].trim();
+	showTimes[i] += 1000;
+	hideTimes[i] += 1000;
+}
+
+// each of these is a single undo step, unchanged texts are skipped
+s.setRichTexts(0, texts, subtitle.Primary);
+s.setTimes(0, showTimes, hideTimes);
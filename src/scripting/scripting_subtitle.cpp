@@ -13,6 +13,8 @@
 #include "scripting/scripting_range.h"
 #include "scripting/scripting_rangelist.h"
 
+#include <KLocalizedString>
+
 using namespace SubtitleComposer;
 
 Scripting::Subtitle::Subtitle(SubtitleComposer::Subtitle *backend, QObject *parent) :
@@ -100,6 +102,142 @@ toTextTarget(int value, int opDefault)
 	return (SubtitleTarget)value;
 }
 
+QVector<SubtitleComposer::SubtitleLine *>
+Scripting::Subtitle::lines(int firstIndex, int lastIndex) const
+{
+	if(firstIndex < 0)
+		firstIndex = 0;
+	if(lastIndex < 0 || lastIndex > m_backend->lastIndex())
+		lastIndex = m_backend->lastIndex();
+
+	QVector<SubtitleComposer::SubtitleLine *> res;
+	if(firstIndex > lastIndex)
+		return res;
+	res.reserve(lastIndex - firstIndex + 1);
+	for(int i = firstIndex; i <= lastIndex; i++)
+		res.push_back(m_backend->at(i));
+	return res;
+}
+
+QVariantList
+Scripting::Subtitle::showTimes(int firstIndex, int lastIndex) const
+{
+	QVariantList res;
+	const QVector<SubtitleComposer::SubtitleLine *> lns = lines(firstIndex, lastIndex);
+	res.reserve(lns.size());
+	for(const SubtitleComposer::SubtitleLine *line: lns)
+		res.push_back(int(line->showTime().toMillis()));
+	return res;
+}
+
+QVariantList
+Scripting::Subtitle::hideTimes(int firstIndex, int lastIndex) const
+{
+	QVariantList res;
+	const QVector<SubtitleComposer::SubtitleLine *> lns = lines(firstIndex, lastIndex);
+	res.reserve(lns.size());
+	for(const SubtitleComposer::SubtitleLine *line: lns)
+		res.push_back(int(line->hideTime().toMillis()));
+	return res;
+}
+
+QVariantList
+Scripting::Subtitle::plainTexts(int firstIndex, int lastIndex, int target) const
+{
+	QVariantList res;
+	const QVector<SubtitleComposer::SubtitleLine *> lns = lines(firstIndex, lastIndex);
+	res.reserve(lns.size());
+	for(const SubtitleComposer::SubtitleLine *line: lns)
+		res.push_back(target == Secondary ? line->secondaryPlainText() : line->primaryPlainText());
+	return res;
+}
+
+QVariantList
+Scripting::Subtitle::richTexts(int firstIndex, int lastIndex, int target) const
+{
+	QVariantList res;
+	const QVector<SubtitleComposer::SubtitleLine *> lns = lines(firstIndex, lastIndex);
+	res.reserve(lns.size());
+	for(const SubtitleComposer::SubtitleLine *line: lns)
+		res.push_back(target == Secondary ? line->secondaryText().richString() : line->primaryText().richString());
+	return res;
+}
+
+void
+Scripting::Subtitle::setTimes(int firstIndex, const QVariantList &showTimes, const QVariantList &hideTimes)
+{
+	if(firstIndex < 0 || (showTimes.isEmpty() && hideTimes.isEmpty()))
+		return;
+
+	// lines can get reordered while changing times - keep pointers to them
+	const QVector<SubtitleComposer::SubtitleLine *> lns = lines(firstIndex, firstIndex + qMax(showTimes.size(), hideTimes.size()) - 1);
+	if(lns.isEmpty())
+		return;
+
+	SubtitleCompositeActionExecutor executor(m_backend.data(), i18n("Set Lines Times"));
+	for(int i = 0, n = lns.size(); i < n; i++) {
+		SubtitleComposer::SubtitleLine *line = lns.at(i);
+		bool ok = false;
+		double showTime = i < showTimes.size() ? showTimes.at(i).toDouble(&ok) : 0.;
+		if(!ok)
+			showTime = line->showTime().toMillis();
+		double hideTime = i < hideTimes.size() ? hideTimes.at(i).toDouble(&ok) : 0.;
+		if(!ok)
+			hideTime = line->hideTime().toMillis();
+		line->setTimes(showTime, hideTime);
+	}
+}
+
+/**
+ * @brief Compares text and complete style, setting unchanged text would needlessly create line's document
+ */
+static bool
+sameText(const SubtitleComposer::RichString &a, const SubtitleComposer::RichString &b)
+{
+	return a.length() == b.length() && a.commonPrefixLength(b) == a.length();
+}
+
+void
+Scripting::Subtitle::setTexts(int firstIndex, const QVariantList &texts, int target, bool rich)
+{
+	if(firstIndex < 0 || texts.isEmpty())
+		return;
+
+	const QVector<SubtitleComposer::SubtitleLine *> lns = lines(firstIndex, firstIndex + texts.size() - 1);
+	if(lns.isEmpty())
+		return;
+
+	// default target depends on application mode, explicit one doesn't need it
+	if(target < Primary || target >= SubtitleTargetSize)
+		target = app()->translationMode() ? Both : Primary;
+
+	SubtitleCompositeActionExecutor executor(m_backend.data(), i18n("Set Lines Texts"));
+	for(int i = 0, n = qMin(lns.size(), texts.size()); i < n; i++) {
+		const QVariant &value = texts.at(i);
+		if(value.isNull())
+			continue;
+		const SubtitleComposer::RichString text = rich
+				? SubtitleComposer::RichString::fromRichString(value.toString())
+				: SubtitleComposer::RichString(value.toString());
+		if(target != Secondary && !sameText(lns.at(i)->primaryText(), text))
+			lns.at(i)->setPrimaryText(text);
+		if((target == Secondary || target == Both) && !sameText(lns.at(i)->secondaryText(), text))
+			lns.at(i)->setSecondaryText(text);
+	}
+}
+
+void
+Scripting::Subtitle::setPlainTexts(int firstIndex, const QVariantList &texts, int target)
+{
+	setTexts(firstIndex, texts, target, false);
+}
+
+void
+Scripting::Subtitle::setRichTexts(int firstIndex, const QVariantList &texts, int target)
+{
+	setTexts(firstIndex, texts, target, true);
+}
+
 Scripting::SubtitleLine *
 Scripting::Subtitle::insertNewLine(int index, bool timeAfter, int target)
 {
@@ -14,6 +14,10 @@
 
 #include <QExplicitlySharedDataPointer>
 #include <QObject>
+#include <QVariantList>
+#include <QVector>
+
+class SubtitleTest;
 
 namespace SubtitleComposer {
 class Subtitle;
@@ -37,6 +41,18 @@ public slots:
 	QObject * lastLine();
 	QObject * line(int index);
 
+/// NOTE: bulk accessors work on lines [firstIndex, lastIndex] (lastIndex < 0 means last line)
+/// and use plain arrays instead of line objects, making them much faster on big subtitles.
+/// Setters change lines starting at firstIndex as a single undo action, negative firstIndex is ignored.
+	QVariantList showTimes(int firstIndex = 0, int lastIndex = -1) const;
+	QVariantList hideTimes(int firstIndex = 0, int lastIndex = -1) const;
+	QVariantList plainTexts(int firstIndex = 0, int lastIndex = -1, int target = -1) const;
+	QVariantList richTexts(int firstIndex = 0, int lastIndex = -1, int target = -1) const;
+
+	void setTimes(int firstIndex, const QVariantList &showTimes, const QVariantList &hideTimes);
+	void setPlainTexts(int firstIndex, const QVariantList &texts, int target = -1);
+	void setRichTexts(int firstIndex, const QVariantList &texts, int target = -1);
+
 	void changeFramesPerSecond(double toFramesPerSecond, double fromFramesPerSecond = -1.0);
 
 	SubtitleLine * insertNewLine(int index, bool timeAfter, int target = -1);
@@ -80,7 +96,11 @@ public slots:
 private:
 	static SubtitleComposer::RangeList toRangesList(const QObject *object);
 
+	QVector<SubtitleComposer::SubtitleLine *> lines(int firstIndex, int lastIndex) const;
+	void setTexts(int firstIndex, const QVariantList &texts, int target, bool rich);
+
 	friend class SubtitleModule;
+	friend class ::SubtitleTest;
 
 	Subtitle(SubtitleComposer::Subtitle *backend, QObject *parent);
 
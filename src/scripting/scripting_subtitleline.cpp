@@ -79,7 +79,7 @@ Scripting::SubtitleLine::primaryLines() const
 QObject *
 Scripting::SubtitleLine::primaryText() const
 {
-	return new Scripting::RichString(m_backend->primaryDoc()->toRichText(), const_cast<Scripting::SubtitleLine *>(this));
+	return new Scripting::RichString(m_backend->primaryText(), const_cast<Scripting::SubtitleLine *>(this));
 }
 
 void
@@ -93,7 +93,7 @@ Scripting::SubtitleLine::setPrimaryText(QObject *object)
 QString
 Scripting::SubtitleLine::plainPrimaryText() const
 {
-	return m_backend->primaryDoc()->toPlainText();
+	return m_backend->primaryPlainText();
 }
 
 void
@@ -105,7 +105,7 @@ Scripting::SubtitleLine::setPlainPrimaryText(const QString &plainText)
 QString
 Scripting::SubtitleLine::richPrimaryText() const
 {
-	return m_backend->primaryDoc()->toRichText().richString();
+	return m_backend->primaryText().richString();
 }
 
 void
@@ -137,7 +137,7 @@ Scripting::SubtitleLine::secondaryLines() const
 QObject *
 Scripting::SubtitleLine::secondaryText() const
 {
-	return new Scripting::RichString(m_backend->secondaryDoc()->toRichText(), const_cast<Scripting::SubtitleLine *>(this));
+	return new Scripting::RichString(m_backend->secondaryText(), const_cast<Scripting::SubtitleLine *>(this));
 }
 
 void
@@ -153,7 +153,7 @@ Scripting::SubtitleLine::setSecondaryText(QObject *object)
 QString
 Scripting::SubtitleLine::plainSecondaryText() const
 {
-	return m_backend->secondaryDoc()->toPlainText();
+	return m_backend->secondaryPlainText();
 }
 
 void
@@ -166,7 +166,7 @@ Scripting::SubtitleLine::setPlainSecondaryText(const QString &plainText)
 QString
 Scripting::SubtitleLine::richSecondaryText() const
 {
-	return m_backend->secondaryDoc()->toRichText();
+	return m_backend->secondaryText();
 }
 
 void
@@ -412,5 +412,5 @@ Scripting::SubtitleLine::check(int errorFlagsToCheck, bool update)
 bool
 Scripting::SubtitleLine::isRightToLeft() const
 {
-	return m_backend->primaryDoc()->toPlainText().isRightToLeft();
+	return m_backend->primaryPlainText().isRightToLeft();
 }
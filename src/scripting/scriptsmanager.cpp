@@ -21,12 +21,14 @@
 #include <QAbstractItemModel>
 #include <QStandardPaths>
 #include <QDialog>
+#include <QElapsedTimer>
 #include <QFileDialog>
 #include <QJSEngine>
 #include <QMenuBar>
 #include <QMenu>
 #include <QDesktopServices>
 #include <QKeyEvent>
+#include <QLoggingCategory>
 #include <QStringBuilder>
 
 #include <KMessageBox>
@@ -34,6 +36,9 @@
 #include <KLocalizedString>
 #include <kwidgetsaddons_version.h>
 
+// script timings, enable with QT_LOGGING_RULES="subtitlecomposer.scripts.debug=true"
+Q_LOGGING_CATEGORY(scriptsLog, "subtitlecomposer.scripts", QtWarningMsg)
+
 inline static const QDir &
 userScriptDir()
 {
@@ -364,7 +369,7 @@ class Debug : public QObject
 	Q_OBJECT
 
 public:
-	Debug() {}
+	explicit Debug(QObject *parent = nullptr) : QObject(parent) {}
 	~Debug() {}
 
 public slots:
@@ -391,7 +396,8 @@ public slots:
 using namespace SubtitleComposer;
 
 ScriptsManager::ScriptsManager(QObject *parent)
-	: QObject(parent)
+	: QObject(parent),
+	  m_engine(nullptr)
 {
 	m_dialog = new QDialog(app()->mainWindow());
 	setupUi(m_dialog);
@@ -431,7 +437,7 @@ ScriptsManager::ScriptsManager(QObject *parent)
 
 ScriptsManager::~ScriptsManager()
 {
-
+	resetScriptEngine();
 }
 
 void
@@ -621,26 +627,34 @@ ScriptsManager::runScript(const QString &sN)
 	if(!script || !script->isScript())
 		return;
 
-	QJSEngine jse;
-	jse.installExtensions(QJSEngine::ConsoleExtension);
-	jse.globalObject().setProperty("ranges", jse.newQObject(new Scripting::RangesModule));
-	jse.globalObject().setProperty("strings", jse.newQObject(new Scripting::StringsModule));
-	jse.globalObject().setProperty("subtitle", jse.newQObject(new Scripting::SubtitleModule));
-	jse.globalObject().setProperty("subtitleline", jse.newQObject(new Scripting::SubtitleLineModule));
-	jse.globalObject().setProperty("debug", jse.newQObject(new Debug()));
+	QElapsedTimer timer;
+	timer.start();
+	scriptEngine();
+	const qint64 engineTime = timer.nsecsElapsed();
 
-	QString scriptData = script->content();
-	if(scriptData.isNull()) {
+	const QJSValue function = compiledScript(script);
+	if(function.isUndefined()) {
 		KMessageBox::error(app()->mainWindow(), i18n("Error opening script %1.", script->path()), i18n("Error Running Script"));
 		return;
 	}
+	const qint64 compileTime = timer.nsecsElapsed();
 
-	QJSValue res;
-	{
+	QJSValue res = function;
+	if(function.isCallable()) {
 		// everything done by the script will be undoable in a single step
 		SubtitleCompositeActionExecutor executor(appSubtitle(), script->title());
-		res = jse.evaluate(scriptData, script->name());
+		res = function.call();
 	}
+	const qint64 runTime = timer.nsecsElapsed();
+
+	releaseScriptObjects();
+	// next run starts with pristine globals
+	m_restoreGlobals.call();
+
+	qCDebug(scriptsLog).nospace() << "Script " << script->name()
+		<< " engine: " << engineTime / 1e6 << "ms"
+		<< ", compile: " << (compileTime - engineTime) / 1e6 << "ms"
+		<< ", run: " << (runTime - compileTime) / 1e6 << "ms";
 
 	if(!res.isUndefined()) {
 		if(res.isError()) {
@@ -653,6 +667,118 @@ ScriptsManager::runScript(const QString &sN)
 	}
 }
 
+/**
+ * @brief Snapshots own properties of global object, builtins and their prototypes
+ *
+ * Returned function brings them back to snapshot state, so globals and patched builtins
+ * don't leak between script runs. It only uses functions captured at snapshot time.
+ * Modules are restored only as global properties, their wrappers are left alone.
+ */
+static const QString globalsSnapshotScript = $(
+	"(function(global, modules) {"
+	"	const names = Object.getOwnPropertyNames, descriptor = Object.getOwnPropertyDescriptor, define = Object.defineProperty;"
+	"	const saved = [];"
+	"	const snapshot = function(object) {"
+	"		try {"
+	"			const props = Object.create(null);"
+	"			names(object).forEach(function(name) { props[name] = descriptor(object, name); });"
+	"			saved.push({ object: object, props: props });"
+	"		} catch(e) {}"
+	"	};"
+	"	snapshot(global);"
+	"	names(global).forEach(function(name) {"
+	"		const value = global[name];"
+	"		if(modules.indexOf(name) >= 0 || value === null || (typeof value !== 'object' && typeof value !== 'function'))"
+	"			return;"
+	"		snapshot(value);"
+	"		if(typeof value === 'function' && value.prototype)"
+	"			snapshot(value.prototype);"
+	"	});"
+	"	return function() {"
+	"		for(let i = 0; i < saved.length; i++) {"
+	"			const object = saved[i].object, props = saved[i].props;"
+	"			try {"
+	"				const current = names(object);"
+	"				for(let j = 0; j < current.length; j++) {"
+	"					if(!(current[j] in props))"
+	"						delete object[current[j]];"
+	"				}"
+	"			} catch(e) {}"
+	"			for(const name in props) {"
+	"				try { define(object, name, props[name]); } catch(e) {}"
+	"			}"
+	"		}"
+	"	};"
+	"})");
+
+QJSEngine *
+ScriptsManager::scriptEngine()
+{
+	if(m_engine)
+		return m_engine;
+
+	m_engine = new QJSEngine(this);
+	m_engine->installExtensions(QJSEngine::ConsoleExtension);
+
+	// modules are owned by engine, objects they create for scripts are their children
+	QJSValue moduleNames = m_engine->newArray();
+	const auto addModule = [&](const QString &name, QObject *module){
+		moduleNames.setProperty(quint32(m_scriptModules.size()), name);
+		m_scriptModules.push_back(module);
+		m_engine->globalObject().setProperty(name, m_engine->newQObject(module));
+	};
+	addModule($("ranges"), new Scripting::RangesModule(m_engine));
+	addModule($("strings"), new Scripting::StringsModule(m_engine));
+	addModule($("subtitle"), new Scripting::SubtitleModule(m_engine));
+	addModule($("subtitleline"), new Scripting::SubtitleLineModule(m_engine));
+	addModule($("debug"), new Debug(m_engine));
+
+	m_restoreGlobals = m_engine->evaluate(globalsSnapshotScript).call({ m_engine->globalObject(), moduleNames });
+
+	return m_engine;
+}
+
+QJSValue
+ScriptsManager::compiledScript(const SCScript *script)
+{
+	const QFileInfo fileInfo(script->path());
+	auto it = m_compiledScripts.find(script->path());
+	if(it != m_compiledScripts.end() && it->modified == fileInfo.lastModified() && it->size == fileInfo.size())
+		return it->function;
+
+	const QString scriptData = script->content();
+	if(scriptData.isNull()) {
+		m_compiledScripts.remove(script->path());
+		return QJSValue();
+	}
+
+	// script is wrapped in a function so its top level declarations don't outlive the run,
+	// the opening line is shared with the script to keep reported line numbers
+	const QJSValue function = scriptEngine()->evaluate($("(function() {") % scriptData % $("\n})"), script->name());
+	m_compiledScripts.insert(script->path(), CompiledScript{fileInfo.lastModified(), fileInfo.size(), function});
+	return function;
+}
+
+void
+ScriptsManager::releaseScriptObjects()
+{
+	for(QObject *module: qAsConst(m_scriptModules)) {
+		const QObjectList objects = module->children();
+		qDeleteAll(objects);
+	}
+}
+
+void
+ScriptsManager::resetScriptEngine()
+{
+	// compiled functions must go before the engine that owns them
+	m_compiledScripts.clear();
+	m_restoreGlobals = QJSValue();
+	m_scriptModules.clear();
+	delete m_engine;
+	m_engine = nullptr;
+}
+
 QMenu *
 ScriptsManager::toolsMenu()
 {
@@ -688,6 +814,9 @@ ScriptsManager::findAllFiles(QString directory, QStringList &fileList)
 void
 ScriptsManager::reloadScripts()
 {
+	// reloading also gives scripts a clean engine
+	resetScriptEngine();
+
 	QMenu *toolsMenu = ScriptsManager::toolsMenu();
 	KActionCollection *actionCollection = app()->mainWindow()->actionCollection();
 	UserActionManager *actionManager = UserActionManager::instance();
@@ -9,13 +9,18 @@
 #define SCRIPTSMANAGER_H
 
 #include <QObject>
+#include <QDateTime>
+#include <QHash>
+#include <QJSValue>
 #include <QMap>
 #include <QUrl>
+#include <QVector>
 
 #include "ui_scriptsmanager.h"
 
 QT_FORWARD_DECLARE_CLASS(QAction)
 QT_FORWARD_DECLARE_CLASS(QDialog)
+QT_FORWARD_DECLARE_CLASS(QJSEngine)
 QT_FORWARD_DECLARE_CLASS(QMenu)
 QT_FORWARD_DECLARE_CLASS(QPushButton)
 class TreeView;
@@ -54,11 +59,28 @@ private:
 
 	static void findAllFiles(QString path, QStringList &findAllFiles);
 
+	QJSEngine * scriptEngine();
+	QJSValue compiledScript(const SCScript *script);
+	void releaseScriptObjects();
+	void resetScriptEngine();
+
 private slots:
 	void onToolsMenuActionTriggered(QAction *action);
 
 private:
 	QDialog *m_dialog;
+
+	struct CompiledScript {
+		QDateTime modified;
+		qint64 size;
+		QJSValue function;
+	};
+
+	// engine, modules and compiled scripts are kept between runs, globals are restored after each
+	QJSEngine *m_engine;
+	QVector<QObject *> m_scriptModules;
+	QHash<QString, CompiledScript> m_compiledScripts;
+	QJSValue m_restoreGlobals;
 };
 }
 #endif
@@ -12,9 +12,12 @@
 #include <QThread>
 #include <QPixmap>
 #include <QImage>
+#include <QMutexLocker>
+#include <QVector>
 #include <QRegularExpression>
 
 #include <cinttypes>
+#include <limits>
 
 extern "C" {
 #include <libavcodec/avcodec.h>
@@ -26,10 +29,14 @@ extern "C" {
 
 using namespace SubtitleComposer;
 
+// don't bother splitting audio into segments shorter than this (msec)
+static const quint64 AudioSegmentMinLength = 5 * 60 * 1000;
+
 StreamProcessor::StreamProcessor(QObject *parent)
 	: QThread(parent),
 	  m_opened(false),
 	  m_audioReady(false),
+	  m_audioSegments(1),
 	  m_imageReady(false),
 	  m_textReady(false),
 	  m_avFormat(nullptr),
@@ -353,6 +360,12 @@ StreamProcessor::initText(int streamIndex)
 	return true;
 }
 
+void
+StreamProcessor::setAudioSegments(int segments)
+{
+	m_audioSegments = qMax(1, segments);
+}
+
 bool
 StreamProcessor::start()
 {
@@ -366,6 +379,116 @@ StreamProcessor::start()
 
 void
 StreamProcessor::processAudio()
+{
+	const int64_t streamDuration = m_avStream->duration * 1000 * m_avStream->time_base.num / m_avStream->time_base.den;
+	const int64_t containerDuration = m_avFormat->duration * 1000 / AV_TIME_BASE;
+	m_streamLen = streamDuration > containerDuration ? streamDuration : containerDuration;
+	m_audioDecoded.storeRelease(0);
+
+	const bool seekable = m_avFormat->pb && (m_avFormat->pb->seekable & AVIO_SEEKABLE_NORMAL);
+	const int segments = seekable ? qBound(1, int(m_streamLen / AudioSegmentMinLength), m_audioSegments) : 1;
+
+	if(segments == 1) {
+		processAudioRange(m_avFormat, m_avStream, m_codecCtx, m_swResample, 0, std::numeric_limits<qint64>::min(), std::numeric_limits<qint64>::max());
+	} else {
+		// segment boundaries are in stream timestamp domain
+		const qint64 msecFirst = m_avStream->start_time == AV_NOPTS_VALUE ? 0 : m_avStream->start_time * 1000 * m_avStream->time_base.num / m_avStream->time_base.den;
+		const auto boundary = [&](int i){ return msecFirst + qint64(m_streamLen) * i / segments; };
+
+		QVector<QThread *> threads;
+		for(int i = 1; i < segments; i++) {
+			const qint64 msecStart = boundary(i);
+			const qint64 msecEnd = i == segments - 1 ? std::numeric_limits<qint64>::max() : boundary(i + 1);
+			QThread *thread = QThread::create([this, i, msecStart, msecEnd](){ processAudioSegment(i, msecStart, msecEnd); });
+			thread->start(LowPriority);
+			threads.push_back(thread);
+		}
+
+		processAudioRange(m_avFormat, m_avStream, m_codecCtx, m_swResample, 0, std::numeric_limits<qint64>::min(), boundary(1));
+
+		for(QThread *thread: qAsConst(threads)) {
+			thread->wait();
+			delete thread;
+		}
+	}
+
+	emit streamFinished();
+	QMetaObject::invokeMethod(this, "close", Qt::QueuedConnection);
+}
+
+void
+StreamProcessor::processAudioSegment(int segment, qint64 msecStart, qint64 msecEnd)
+{
+	int ret;
+	char errorText[1024];
+	AVFormatContext *avFormat = nullptr;
+	AVCodecContext *codecCtx = nullptr;
+	SwrContext *swResample = nullptr;
+	AVStream *avStream = nullptr;
+
+	if((ret = avformat_open_input(&avFormat, m_filename.toUtf8().constData(), nullptr, nullptr)) < 0
+			|| (ret = avformat_find_stream_info(avFormat, nullptr)) < 0) {
+		av_strerror(ret, errorText, sizeof(errorText));
+		qWarning() << "Cannot open input file segment:" << errorText;
+		emit streamError(ret, QStringLiteral("Cannot open input file segment"), QString::fromUtf8(errorText));
+		avformat_close_input(&avFormat);
+		return;
+	}
+
+	avStream = avFormat->streams[m_audioStreamCurrent];
+	ret = AVERROR_DECODER_NOT_FOUND;
+	const AVCodec *dec = avcodec_find_decoder(avStream->codecpar->codec_id);
+	codecCtx = dec ? avcodec_alloc_context3(dec) : nullptr;
+	if(!codecCtx
+			|| (ret = avcodec_parameters_to_context(codecCtx, avStream->codecpar)) < 0
+			|| (ret = avcodec_open2(codecCtx, dec, nullptr)) < 0) {
+		av_strerror(ret, errorText, sizeof(errorText));
+		qWarning() << "Failed to open decoder for stream segment" << errorText;
+		emit streamError(ret, QStringLiteral("Failed to open decoder for stream segment"), QString::fromUtf8(errorText));
+		avcodec_free_context(&codecCtx);
+		avformat_close_input(&avFormat);
+		return;
+	}
+
+	if(codecCtx->ch_layout.order != AV_CHANNEL_ORDER_NATIVE) {
+		const int cc = codecCtx->ch_layout.nb_channels;
+		av_channel_layout_uninit(&codecCtx->ch_layout);
+		av_channel_layout_default(&codecCtx->ch_layout, cc);
+	}
+
+	// resample same as the main decoder does
+	if(m_swResample) {
+		swr_alloc_set_opts2(&swResample,
+							m_audioChLayout, AVSampleFormat(m_audioSampleFormat), m_audioStreamFormat.sampleRate(),
+							&codecCtx->ch_layout, codecCtx->sample_fmt, codecCtx->sample_rate,
+							0, nullptr);
+		if(!swResample) {
+			qWarning() << "Cannot create sample rate converter for stream segment" << segment;
+			emit streamError(AVERROR(ENOMEM), QStringLiteral("Cannot create sample rate converter for stream segment"), QString());
+			avcodec_free_context(&codecCtx);
+			avformat_close_input(&avFormat);
+			return;
+		}
+	}
+
+	// seek to keyframe before segment start, frames before it are skipped while decoding
+	ret = av_seek_frame(avFormat, avStream->index, av_rescale_q(msecStart, AVRational{1, 1000}, avStream->time_base), AVSEEK_FLAG_BACKWARD);
+	if(ret < 0) {
+		av_strerror(ret, errorText, sizeof(errorText));
+		qWarning() << "Failed seeking to segment" << segment << "start, decoding from stream start" << errorText;
+	}
+
+	processAudioRange(avFormat, avStream, codecCtx, swResample, segment, msecStart, msecEnd);
+
+	if(swResample)
+		swr_free(&swResample);
+	avcodec_free_context(&codecCtx);
+	avformat_close_input(&avFormat);
+}
+
+void
+StreamProcessor::processAudioRange(AVFormatContext *avFormat, AVStream *avStream, AVCodecContext *codecCtx, SwrContext *swResample,
+								   int segment, qint64 msecStart, qint64 msecEnd)
 {
 	int ret;
 	char errorText[1024];
@@ -375,7 +498,7 @@ StreamProcessor::processAudio()
 	Q_ASSERT(frame != nullptr);
 	AVFrame *frameResampled = nullptr;
 
-	if(m_swResample) {
+	if(swResample) {
 		frameResampled = av_frame_alloc();
 		Q_ASSERT(frameResampled != nullptr);
 		av_channel_layout_uninit(&frameResampled->ch_layout);
@@ -384,19 +507,16 @@ StreamProcessor::processAudio()
 		frameResampled->format = m_audioSampleFormat;
 	}
 
-	const int64_t streamDuration = m_avStream->duration * 1000 * m_avStream->time_base.num / m_avStream->time_base.den;
-	const int64_t containerDuration = m_avFormat->duration * 1000 / AV_TIME_BASE;
-	m_streamLen = streamDuration > containerDuration ? streamDuration : containerDuration;
-
 	int64_t timeFrameStart = 0;
 	int64_t timeFrameDuration = 0;
 	int64_t timeFrameEnd = 0;
 	int64_t timeResampleDelay = 0;
+	int64_t timeProgress = qMax(msecStart, qint64(0));
 
 	bool conversionComplete = false;
 
 	while(!conversionComplete && !isInterruptionRequested()) {
-		ret = av_read_frame(m_avFormat, pkt);
+		ret = av_read_frame(avFormat, pkt);
 		bool drainDecoder = ret == AVERROR_EOF;
 		if(ret < 0 && !drainDecoder) {
 			av_strerror(ret, errorText, sizeof(errorText));
@@ -405,8 +525,8 @@ StreamProcessor::processAudio()
 			break;
 		}
 
-		if(pkt->stream_index == m_audioStreamCurrent || drainDecoder) {
-			ret = avcodec_send_packet(m_codecCtx, pkt);
+		if(pkt->stream_index == avStream->index || drainDecoder) {
+			ret = avcodec_send_packet(codecCtx, pkt);
 			if(ret < 0) {
 				if(ret != AVERROR(EAGAIN)) {
 					av_strerror(ret, errorText, sizeof(errorText));
@@ -416,7 +536,7 @@ StreamProcessor::processAudio()
 				break;
 			}
 			while(!conversionComplete && !isInterruptionRequested()) {
-				ret = avcodec_receive_frame(m_codecCtx, frame);
+				ret = avcodec_receive_frame(codecCtx, frame);
 				bool drainResampler = ret == AVERROR_EOF;
 				if(ret < 0 && !drainResampler) {
 					if(ret != AVERROR(EAGAIN)) {
@@ -428,21 +548,29 @@ StreamProcessor::processAudio()
 				}
 				if(ret == 0) {
 					if(frame->best_effort_timestamp)
-						timeFrameStart = frame->best_effort_timestamp * 1000 * m_avStream->time_base.num / m_avStream->time_base.den;
+						timeFrameStart = frame->best_effort_timestamp * 1000 * avStream->time_base.num / avStream->time_base.den;
+
+					// frames outside of requested range
+					if(timeFrameStart >= msecEnd) {
+						conversionComplete = true;
+						break;
+					}
+					if(timeFrameStart + int64_t(frame->nb_samples) * 1000 / frame->sample_rate <= msecStart)
+						continue;
 				}
 
 				bool drainSampleBuffer = false;
 				do {
 					size_t frameSize;
-					if(m_swResample) {
-						ret = swr_convert_frame(m_swResample, frameResampled, drainSampleBuffer || drainResampler ? nullptr : frame);
+					if(swResample) {
+						ret = swr_convert_frame(swResample, frameResampled, drainSampleBuffer || drainResampler ? nullptr : frame);
 						if(ret < 0) {
 							av_strerror(ret, errorText, sizeof(errorText));
 							qWarning() << "Error resampling audio frame" << errorText;
 							emit streamError(ret, QStringLiteral("Error resampling audio frame"), QString::fromUtf8(errorText));
 							break;
 						}
-						timeResampleDelay = -swr_get_delay(m_swResample, 1000);
+						timeResampleDelay = -swr_get_delay(swResample, 1000);
 						frameSize = frameResampled->nb_samples * av_get_bytes_per_sample(static_cast<AVSampleFormat>(frameResampled->format));
 						timeFrameDuration = frameResampled->nb_samples * 1000 / frameResampled->sample_rate;
 					} else {
@@ -456,20 +584,23 @@ StreamProcessor::processAudio()
 						break;
 					}
 
-					if(!drainResampler) {
-						m_streamPos = timeFrameEnd;
-						emit streamProgress(m_streamPos, m_streamLen);
+					if(!drainResampler && timeFrameEnd > timeProgress) {
+						// progress is sum of what all segments have decoded
+						const quint64 decoded = m_audioDecoded.fetchAndAddOrdered(timeFrameEnd - timeProgress) + (timeFrameEnd - timeProgress);
+						timeProgress = timeFrameEnd;
+						emit streamProgress(decoded, m_streamLen);
 					}
 
-					if(m_swResample) {
+					QMutexLocker l(&m_audioDataMutex);
+					if(swResample) {
 						Q_ASSERT(frameResampled != nullptr);
 						emit audioDataAvailable(frameResampled->data[0], qint32(frameSize * frameResampled->ch_layout.nb_channels),
-							&m_audioStreamFormat, qint64(timeFrameStart + timeResampleDelay), qint64(timeFrameDuration));
+							&m_audioStreamFormat, qint64(timeFrameStart + timeResampleDelay), qint64(timeFrameDuration), segment);
 
-						drainSampleBuffer = swr_get_out_samples(m_swResample, 0) > 1000;
+						drainSampleBuffer = swr_get_out_samples(swResample, 0) > 1000;
 					} else {
 						emit audioDataAvailable(frame->data[0], qint32(frameSize * frame->ch_layout.nb_channels),
-							&m_audioStreamFormat, qint64(timeFrameStart), qint64(timeFrameDuration));
+							&m_audioStreamFormat, qint64(timeFrameStart), qint64(timeFrameDuration), segment);
 					}
 				} while(!conversionComplete && !isInterruptionRequested() && drainSampleBuffer);
 			}
@@ -486,9 +617,6 @@ StreamProcessor::processAudio()
 		av_frame_free(&frameResampled);
 
 	av_packet_free(&pkt);
-
-	emit streamFinished();
-	QMetaObject::invokeMethod(this, "close", Qt::QueuedConnection);
 }
 
 void
@@ -9,6 +9,8 @@
 
 #include "videoplayer/waveformat.h"
 
+#include <QAtomicInteger>
+#include <QMutex>
 #include <QThread>
 #include <QString>
 #include <QStringList>
@@ -38,6 +40,15 @@ public:
 	bool initText(int streamIndex);
 	Q_INVOKABLE void close();
 
+	/**
+	 * @brief Decode audio in up to @p segments parallel segments
+	 *
+	 * Each segment is decoded from its own seek point by a separate thread, so audioDataAvailable()
+	 * is emitted out of order - @p segment argument of the signal tells which segment data belongs to.
+	 * Emitting is serialized, slots are never called concurrently.
+	 */
+	void setAudioSegments(int segments);
+
 	QStringList listAudio();
 	QStringList listText();
 	QStringList listImage();
@@ -45,7 +56,7 @@ public:
 	bool start();
 
 signals:
-	void audioDataAvailable(const void *buffer, const qint32 size, const WaveFormat *waveFormat, const qint64 msecStart, const qint64 msecDuration);
+	void audioDataAvailable(const void *buffer, const qint32 size, const WaveFormat *waveFormat, const qint64 msecStart, const qint64 msecDuration, const int segment);
 	void textDataAvailable(const QString &text, const quint64 msecStart, const quint64 msecDuration);
 	void imageDataAvailable(const QImage &image, const quint64 msecStart, const quint64 msecDuration);
 	void streamProgress(quint64 msecPosition, quint64 msecLength);
@@ -55,6 +66,9 @@ signals:
 protected:
 	int findStream(int streamType, int streamIndex, bool imageSub);
 	void processAudio();
+	void processAudioSegment(int segment, qint64 msecStart, qint64 msecEnd);
+	void processAudioRange(AVFormatContext *avFormat, AVStream *avStream, AVCodecContext *codecCtx, SwrContext *swResample,
+						   int segment, qint64 msecStart, qint64 msecEnd);
 	void processText();
 	virtual void run() override;
 
@@ -66,6 +80,9 @@ private:
 	int m_audioStreamIndex;
 	int m_audioStreamCurrent;
 	WaveFormat m_audioStreamFormat;
+	int m_audioSegments;
+	QAtomicInteger<quint64> m_audioDecoded;
+	QMutex m_audioDataMutex;
 
 	bool m_imageReady;
 	int m_imageStreamIndex;
@@ -0,0 +1,515 @@
+/*
+    SPDX-FileCopyrightText: 2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "corebench.h"
+#include "subripreference.h"
+
+#include "core/richstring.h"
+#include "core/richtext/richdocument.h"
+#include "core/subtitle.h"
+#include "core/subtitleline.h"
+#include "formats/formatmanager.h"
+#include "formats/inputformat.h"
+#include "formats/outputformat.h"
+#include "gui/waveform/wavekernels.h"
+#include "helpers/common.h"
+
+#include <QApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QXmlStreamReader>
+
+#include <klocalizedstring.h>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+using namespace SubtitleComposer;
+
+Q_DECLARE_METATYPE(const WaveKernels *)
+
+namespace {
+const int cueCounts[] = { 1000, 10000, 100000 };
+
+QByteArray
+countTag(int cues)
+{
+	return QByteArray::number(cues / 1000) + 'k';
+}
+
+void
+addCountRows()
+{
+	QTest::addColumn<int>("cues");
+
+	for(int cues: cueCounts)
+		QTest::newRow(countTag(cues).constData()) << cues;
+}
+
+void
+addFormatRows(const QStringList &formats)
+{
+	QTest::addColumn<QString>("format");
+	QTest::addColumn<int>("cues");
+
+	for(const QString &format: formats) {
+		for(int cues: cueCounts)
+			QTest::newRow((format.toUtf8() + '/' + countTag(cues)).constData()) << format << cues;
+	}
+}
+
+QString
+cueText(int index)
+{
+	return $("Line <i>number</i> %1\n<b>second</b> row").arg(index + 1);
+}
+
+QStringList
+cueTexts(int cues)
+{
+	QStringList texts;
+	texts.reserve(cues);
+	for(int i = 0; i < cues; i++)
+		texts.append(cueText(i));
+	return texts;
+}
+
+/**
+ * @brief Synthetic subtitle with a cue every @p spacing ms, lines are in random time order when @p shuffled is set
+ */
+Subtitle *
+createSubtitle(int cues, double spacing = 1000., double duration = 800., bool shuffled = false)
+{
+	Subtitle *subtitle = new Subtitle();
+
+	SubtitleLineBatch batch(subtitle, cues);
+	for(int i = 0; i < cues; i++) {
+		SubtitleLine *line = new SubtitleLine(Time(i * spacing), Time(i * spacing + duration));
+		line->setPrimaryText(RichString::fromRichString(cueText(i)));
+		batch.append(line);
+	}
+	batch.commit();
+
+	if(shuffled) {
+		QVector<int> order(cues);
+		std::iota(order.begin(), order.end(), 0);
+		std::shuffle(order.begin(), order.end(), std::mt19937(cues));
+		for(int i = 0; i < cues; i++)
+			subtitle->at(i)->setTimes(Time(order[i] * spacing), Time(order[i] * spacing + duration));
+	}
+
+	return subtitle;
+}
+
+QStringList
+textFormats()
+{
+	QStringList formats;
+	const FormatManager &fm = FormatManager::instance();
+	for(const QString &name: fm.outputNames()) {
+		if(fm.hasInput(name) && !fm.input(name)->isBinary())
+			formats.append(name);
+	}
+	return formats;
+}
+}
+
+void
+CoreBench::benchmarkFormatWrite_data()
+{
+	addFormatRows(FormatManager::instance().outputNames());
+}
+
+void
+CoreBench::benchmarkFormatWrite()
+{
+	QFETCH(QString, format);
+	QFETCH(int, cues);
+
+	const OutputFormat *output = FormatManager::instance().output(format);
+	QVERIFY(output);
+	QExplicitlySharedDataPointer<Subtitle> subtitle(createSubtitle(cues));
+
+	QBENCHMARK {
+		const QString data = output->writeSubtitle(*subtitle, true);
+		QVERIFY(!data.isEmpty());
+	}
+}
+
+void
+CoreBench::benchmarkFormatRead_data()
+{
+	addFormatRows(textFormats());
+}
+
+void
+CoreBench::benchmarkFormatRead()
+{
+	QFETCH(QString, format);
+	QFETCH(int, cues);
+
+	const FormatManager &fm = FormatManager::instance();
+	const QString data = fm.output(format)->writeSubtitle(*QExplicitlySharedDataPointer<Subtitle>(createSubtitle(cues)), true);
+
+	QBENCHMARK {
+		QExplicitlySharedDataPointer<Subtitle> subtitle(new Subtitle());
+		QVERIFY(fm.input(format)->readSubtitle(*subtitle, true, data));
+	}
+}
+
+void
+CoreBench::benchmarkSubRipParse_data()
+{
+	QTest::addColumn<bool>("regex");
+	QTest::addColumn<int>("cues");
+
+	for(int cues: cueCounts) {
+		QTest::newRow(("regex/" + countTag(cues)).constData()) << true << cues;
+		QTest::newRow(("tokenizer/" + countTag(cues)).constData()) << false << cues;
+	}
+}
+
+void
+CoreBench::benchmarkSubRipParse()
+{
+	QFETCH(bool, regex);
+	QFETCH(int, cues);
+
+	const QString data = generateSubRip(cues);
+
+	QBENCHMARK {
+		QExplicitlySharedDataPointer<Subtitle> subtitle(new Subtitle());
+		if(regex)
+			parseSubtitlesRegEx(*subtitle, data);
+		else
+			SubRipInput().parseSubtitles(*subtitle, data);
+		QCOMPARE(subtitle->count(), cues);
+	}
+}
+
+void
+CoreBench::benchmarkShiftLines_data()
+{
+	addCountRows();
+}
+
+void
+CoreBench::benchmarkShiftLines()
+{
+	QFETCH(int, cues);
+
+	QExplicitlySharedDataPointer<Subtitle> subtitle(createSubtitle(cues));
+
+	QBENCHMARK {
+		subtitle->shiftLines(RangeList(Range::full()), 1000);
+	}
+}
+
+void
+CoreBench::benchmarkSortLines_data()
+{
+	addCountRows();
+}
+
+void
+CoreBench::benchmarkSortLines()
+{
+	QFETCH(int, cues);
+
+	QExplicitlySharedDataPointer<Subtitle> subtitle(createSubtitle(cues, 1000., 800., true));
+
+	// lines are sorted after first run
+	QBENCHMARK_ONCE {
+		subtitle->sortLines(Range::full());
+	}
+
+	for(int i = 1; i < cues; i++)
+		QVERIFY(subtitle->at(i - 1)->showTime() <= subtitle->at(i)->showTime());
+}
+
+void
+CoreBench::benchmarkFixOverlappingLines_data()
+{
+	addCountRows();
+}
+
+void
+CoreBench::benchmarkFixOverlappingLines()
+{
+	QFETCH(int, cues);
+
+	// every line overlaps the next one
+	QExplicitlySharedDataPointer<Subtitle> subtitle(createSubtitle(cues, 1000., 1200.));
+
+	// there is nothing left to fix after first run
+	QBENCHMARK_ONCE {
+		subtitle->fixOverlappingLines(RangeList(Range::full()));
+	}
+}
+
+void
+CoreBench::benchmarkApplyDurationLimits_data()
+{
+	addCountRows();
+}
+
+void
+CoreBench::benchmarkApplyDurationLimits()
+{
+	QFETCH(int, cues);
+
+	QExplicitlySharedDataPointer<Subtitle> subtitle(createSubtitle(cues, 1000., 200.));
+
+	QBENCHMARK_ONCE {
+		subtitle->applyDurationLimits(RangeList(Range::full()), 500, 5000, false);
+	}
+}
+
+void
+CoreBench::benchmarkSetMaximumDurations_data()
+{
+	addCountRows();
+}
+
+void
+CoreBench::benchmarkSetMaximumDurations()
+{
+	QFETCH(int, cues);
+
+	QExplicitlySharedDataPointer<Subtitle> subtitle(createSubtitle(cues));
+
+	QBENCHMARK_ONCE {
+		subtitle->setMaximumDurations(RangeList(Range::full()));
+	}
+}
+
+void
+CoreBench::benchmarkTimesScan_data()
+{
+	QTest::addColumn<int>("cues");
+	QTest::addColumn<bool>("mirror");
+
+	for(int cues: cueCounts) {
+		QTest::newRow((countTag(cues) + "/lines").constData()) << cues << false;
+		QTest::newRow((countTag(cues) + "/mirror").constData()) << cues << true;
+	}
+}
+
+void
+CoreBench::benchmarkTimesScan()
+{
+	QFETCH(int, cues);
+	QFETCH(bool, mirror);
+
+	// overlap scan that doesn't change anything - compares reading times through lines with reading mirrored arrays
+	QExplicitlySharedDataPointer<Subtitle> subtitle(createSubtitle(cues));
+	std::vector<double> hideTimes(cues);
+
+	QBENCHMARK {
+		if(mirror) {
+			const SubtitleTimes &times = subtitle->times();
+			SubtitleTimes::fixOverlaps(times.showTimes(), times.hideTimes(), cues, 100., hideTimes.data());
+		} else {
+			for(int i = 0; i < cues - 1; i++) {
+				const SubtitleLine *line = subtitle->at(i);
+				const double limit = subtitle->at(i + 1)->showTime().toMillis() - 100.;
+				hideTimes[i] = line->hideTime().toMillis() >= limit ? qMax(limit, line->showTime().toMillis()) : line->hideTime().toMillis();
+			}
+		}
+	}
+}
+
+void
+CoreBench::benchmarkRichStringFromRich_data()
+{
+	addCountRows();
+}
+
+void
+CoreBench::benchmarkRichStringFromRich()
+{
+	QFETCH(int, cues);
+
+	const QStringList texts = cueTexts(cues);
+
+	QBENCHMARK {
+		for(const QString &text: texts)
+			RichString::fromRichString(text);
+	}
+}
+
+void
+CoreBench::benchmarkRichStringToRich_data()
+{
+	addCountRows();
+}
+
+void
+CoreBench::benchmarkRichStringToRich()
+{
+	QFETCH(int, cues);
+
+	QVector<RichString> texts;
+	texts.reserve(cues);
+	for(const QString &text: cueTexts(cues))
+		texts.append(RichString::fromRichString(text));
+
+	QBENCHMARK {
+		for(const RichString &text: qAsConst(texts))
+			text.richString();
+	}
+}
+
+void
+CoreBench::benchmarkRichDocumentSetRichText_data()
+{
+	addCountRows();
+}
+
+void
+CoreBench::benchmarkRichDocumentSetRichText()
+{
+	QFETCH(int, cues);
+
+	QVector<RichString> texts;
+	texts.reserve(cues);
+	for(const QString &text: cueTexts(cues))
+		texts.append(RichString::fromRichString(text));
+
+	RichDocument doc;
+	QBENCHMARK {
+		for(const RichString &text: qAsConst(texts))
+			doc.setRichText(text, true);
+	}
+}
+
+void
+CoreBench::benchmarkWaveKernels_data()
+{
+	QTest::addColumn<const WaveKernels *>("kernels");
+	QTest::addColumn<bool>("blocks");
+
+	for(const WaveKernels *k: WaveKernels::available()) {
+		QTest::newRow(QByteArray(k->name) + "/blocks") << k << true;
+		QTest::newRow(QByteArray(k->name) + "/range") << k << false;
+	}
+}
+
+void
+CoreBench::benchmarkWaveKernels()
+{
+	QFETCH(const WaveKernels *, kernels);
+	QFETCH(bool, blocks);
+
+	QVector<qint16> samples(1 << 22);
+	std::mt19937 rng(samples.size());
+	std::uniform_int_distribution<int> dist(-32768, 32767);
+	for(qint16 &s: samples)
+		s = qint16(dist(rng));
+
+	QVector<WavePeak> peaks(samples.size() >> WaveKernels::BlockShift);
+	quint64 sum = 0;
+	quint32 max = 0;
+
+	qint64 nsecs = 0;
+	qint64 processed = 0;
+	QElapsedTimer timer;
+	QBENCHMARK {
+		timer.start();
+		if(blocks)
+			kernels->reduceBlocks(samples.constData(), peaks.size(), peaks.data());
+		else
+			kernels->reduceRange(samples.constData(), samples.size(), &sum, &max);
+		nsecs += timer.nsecsElapsed();
+		processed += samples.size();
+	}
+
+	qInfo("%s: %.1f Msamples/s", QTest::currentDataTag(), processed * 1000. / qMax(nsecs, qint64(1)));
+}
+
+/**
+ * @brief Converts BenchmarkResult elements of QtTest XML log into JSON
+ */
+static bool
+writeJsonResults(const QString &xmlFile, const QString &jsonFile)
+{
+	QFile xml(xmlFile);
+	if(!xml.open(QIODevice::ReadOnly))
+		return false;
+
+	QJsonArray results;
+	QString function;
+	QXmlStreamReader reader(&xml);
+	while(!reader.atEnd()) {
+		if(reader.readNext() != QXmlStreamReader::StartElement)
+			continue;
+		const QXmlStreamAttributes attrs = reader.attributes();
+		if(reader.name() == QLatin1String("TestFunction")) {
+			function = attrs.value(QLatin1String("name")).toString();
+		} else if(reader.name() == QLatin1String("BenchmarkResult")) {
+			results.append(QJsonObject{
+				{ $("function"), function },
+				{ $("tag"), attrs.value(QLatin1String("tag")).toString() },
+				{ $("metric"), attrs.value(QLatin1String("metric")).toString() },
+				{ $("value"), attrs.value(QLatin1String("value")).toDouble() },
+				{ $("iterations"), attrs.value(QLatin1String("iterations")).toInt() },
+			});
+		}
+	}
+	if(reader.hasError())
+		return false;
+
+	QFile json(jsonFile);
+	if(!json.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+	const QJsonObject root{
+		{ $("suite"), $("bench-core") },
+		{ $("qt"), QString::fromLatin1(qVersion()) },
+		{ $("results"), results },
+	};
+	return json.write(QJsonDocument(root).toJson()) > 0;
+}
+
+/**
+ * Usage: bench-core [-json <file>] [QtTest options]
+ * Results are printed and written as JSON to <file> (bench-core.json by default).
+ */
+int
+main(int argc, char *argv[])
+{
+	QApplication app(argc, argv);
+	KLocalizedString::setApplicationDomain("subtitlecomposer");
+
+	QStringList args = app.arguments();
+	QString jsonFile = $("bench-core.json");
+	const int jsonArg = args.indexOf($("-json"));
+	if(jsonArg > 0 && jsonArg + 1 < args.size()) {
+		jsonFile = args.at(jsonArg + 1);
+		args.erase(args.begin() + jsonArg, args.begin() + jsonArg + 2);
+	}
+
+	QTemporaryDir tmpDir;
+	if(!tmpDir.isValid())
+		return 1;
+	const QString xmlFile = tmpDir.filePath($("bench-core.xml"));
+	args << $("-o") << xmlFile + $(",xml") << $("-o") << $("-,txt");
+
+	CoreBench bench;
+	const int res = QTest::qExec(&bench, args);
+
+	if(!writeJsonResults(xmlFile, jsonFile)) {
+		qWarning() << "Failed writing benchmark results to" << jsonFile;
+		return res ? res : 1;
+	}
+	return res;
+}
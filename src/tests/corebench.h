@@ -0,0 +1,48 @@
+/*
+    SPDX-FileCopyrightText: 2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef COREBENCH_H
+#define COREBENCH_H
+
+#include <QObject>
+
+class CoreBench : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void benchmarkFormatWrite_data();
+	void benchmarkFormatWrite();
+	void benchmarkFormatRead_data();
+	void benchmarkFormatRead();
+	void benchmarkSubRipParse_data();
+	void benchmarkSubRipParse();
+
+	void benchmarkShiftLines_data();
+	void benchmarkShiftLines();
+	void benchmarkSortLines_data();
+	void benchmarkSortLines();
+	void benchmarkFixOverlappingLines_data();
+	void benchmarkFixOverlappingLines();
+	void benchmarkApplyDurationLimits_data();
+	void benchmarkApplyDurationLimits();
+	void benchmarkSetMaximumDurations_data();
+	void benchmarkSetMaximumDurations();
+	void benchmarkTimesScan_data();
+	void benchmarkTimesScan();
+
+	void benchmarkRichStringFromRich_data();
+	void benchmarkRichStringFromRich();
+	void benchmarkRichStringToRich_data();
+	void benchmarkRichStringToRich();
+	void benchmarkRichDocumentSetRichText_data();
+	void benchmarkRichDocumentSetRichText();
+
+	void benchmarkWaveKernels_data();
+	void benchmarkWaveKernels();
+};
+
+#endif // COREBENCH_H
@@ -0,0 +1,128 @@
+/*
+    SPDX-FileCopyrightText: 2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "formatmanagertest.h"
+
+#include "core/subtitle.h"
+#include "core/subtitleline.h"
+#include "formats/formatmanager.h"
+#include "helpers/common.h"
+
+#include <QBuffer>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QTextCodec>
+
+using namespace SubtitleComposer;
+
+void
+FormatManagerTest::testWriteEncoded_data()
+{
+	QTest::addColumn<int>("lineBreak");
+	QTest::addColumn<QString>("lineBreakText");
+
+	QTest::newRow("LF") << 0 << $("\n");
+	QTest::newRow("CRLF") << 1 << $("\r\n");
+	QTest::newRow("CR") << 2 << $("\r");
+}
+
+void
+FormatManagerTest::testWriteEncoded()
+{
+	QFETCH(int, lineBreak);
+	QFETCH(QString, lineBreakText);
+
+	// line breaks in both chunks, surrogate pair starts at the last character of the first 64K chunk
+	QString data = $("first\nline\n");
+	data.append(QString(64 * 1024 - 1 - data.size(), QChar('a')));
+	data.append(QString::fromUcs4(U"\U0001F600"));
+	data.append($("\nlast\nline\n"));
+	QVERIFY(data.at(64 * 1024 - 1).isHighSurrogate());
+
+	QTextCodec *codec = QTextCodec::codecForName("UTF-8");
+	QBuffer buffer;
+	buffer.open(QIODevice::WriteOnly);
+	QVERIFY(FormatManager::writeEncoded(&buffer, data, codec, lineBreak));
+
+	const QByteArray expected = QByteArray("\xEF\xBB\xBF") + QString(data).replace(QChar::LineFeed, lineBreakText).toUtf8();
+	QCOMPARE(buffer.data().size(), expected.size());
+	QCOMPARE(buffer.data(), expected);
+}
+
+void
+FormatManagerTest::testWriteSubtitles()
+{
+	QExplicitlySharedDataPointer<Subtitle> subtitle(new Subtitle());
+	{
+		SubtitleLineBatch batch(subtitle.data());
+		for(int i = 0; i < 100; i++) {
+			SubtitleLine *line = new SubtitleLine(i * 1000., i * 1000. + 800.);
+			line->setPrimaryText(RichString::fromRichString($("Line <i>%1</i>\nsecond row").arg(i + 1)));
+			batch.append(line);
+		}
+	}
+
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	QTextCodec *codec = QTextCodec::codecForName("UTF-8");
+	const FormatManager &fm = FormatManager::instance();
+
+	QVector<FormatManager::WriteJob> jobs;
+	const QStringList formats = { $("SubRip"), $("WebVTT"), $("Advanced SubStation Alpha") };
+	const QStringList extensions = { $("srt"), $("vtt"), $("ass") };
+	for(int i = 0; i < formats.size(); i++) {
+		FormatManager::WriteJob job;
+		job.url = QUrl::fromLocalFile(dir.filePath($("batch.") + extensions.at(i)));
+		job.format = formats.at(i);
+		jobs.push_back(job);
+	}
+	QVERIFY(fm.writeSubtitles(*subtitle, true, jobs, codec, true));
+
+	for(int i = 0; i < jobs.size(); i++) {
+		QVERIFY(jobs.at(i).success);
+
+		const QUrl single = QUrl::fromLocalFile(dir.filePath($("single.") + extensions.at(i)));
+		QVERIFY(fm.writeSubtitle(*subtitle, true, single, codec, formats.at(i), true));
+
+		QFile batchFile(jobs.at(i).url.toLocalFile());
+		QFile singleFile(single.toLocalFile());
+		QVERIFY(batchFile.open(QIODevice::ReadOnly));
+		QVERIFY(singleFile.open(QIODevice::ReadOnly));
+		const QByteArray bytes = singleFile.readAll();
+		QVERIFY(bytes.startsWith("\xEF\xBB\xBF") && !bytes.mid(3).startsWith("\xEF\xBB\xBF"));
+		QCOMPARE(batchFile.readAll(), bytes);
+	}
+}
+
+void
+FormatManagerTest::testReadUnprobed()
+{
+	// preamble longer than the probed prefix and an extension no format knows
+	QString data;
+	while(data.size() < 16 * 1024)
+		data.append($("Preamble without any subtitle data in it\n"));
+	data.append($("1\n00:00:01,000 --> 00:00:02,500\nFirst line\n\n"
+				  "2\n00:00:03,000 --> 00:00:04,500\nSecond line\n\n"));
+
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	QFile file(dir.filePath($("preamble.dat")));
+	QVERIFY(file.open(QIODevice::WriteOnly));
+	QVERIFY(file.write(data.toUtf8()) > 0);
+	file.close();
+
+	QExplicitlySharedDataPointer<Subtitle> subtitle(new Subtitle());
+	QTextCodec *codec = QTextCodec::codecForName("UTF-8");
+	QString formatName;
+	QCOMPARE(FormatManager::instance().readSubtitle(*subtitle, true, QUrl::fromLocalFile(file.fileName()), &codec, &formatName), FormatManager::SUCCESS);
+	QCOMPARE(formatName, $("SubRip"));
+	QCOMPARE(subtitle->count(), 2);
+	QCOMPARE(subtitle->line(0)->showTime().toMillis(), 1000.);
+	QCOMPARE(subtitle->line(1)->primaryText().string(), $("Second line"));
+}
+
+QTEST_MAIN(FormatManagerTest);
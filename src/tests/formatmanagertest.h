@@ -0,0 +1,23 @@
+/*
+    SPDX-FileCopyrightText: 2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef FORMATMANAGERTEST_H
+#define FORMATMANAGERTEST_H
+
+#include <QObject>
+
+class FormatManagerTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void testWriteEncoded_data();
+	void testWriteEncoded();
+	void testWriteSubtitles();
+	void testReadUnprobed();
+};
+
+#endif // FORMATMANAGERTEST_H
@@ -6,6 +6,7 @@
 
 #include "richdocumentlayouttest.h"
 
+#include "core/richtext/richcss.h"
 #include "core/richtext/richdocument.h"
 #include "helpers/debug.h"
 
@@ -158,4 +159,36 @@ RichDocumentLayoutTest::testMerge()
 	QVERIFY2(compare(richLayout.mergeCSS(docFmts, res), mergedFmts), "Compared values are not the same");
 }
 
+void
+RichDocumentLayoutTest::testApplyCSS()
+{
+	RichCSS css;
+	css.parse(QStringLiteral(".red { color: #ff0000; } b { color: #0000ff; } v[voice=Joe] { font-style: italic; }"));
+	RichDocument doc;
+	doc.setStylesheet(&css);
+	RichDocumentLayout *layout = new RichDocumentLayout(&doc);
+
+	QTextCharFormat cls;
+	cls.setProperty(RichDocument::Class, QVariant::fromValue(QSet<QString>{QStringLiteral("red")}));
+	QTextCharFormat bold;
+	bold.setFontWeight(QFont::Bold);
+	QTextCharFormat voice;
+	voice.setProperty(RichDocument::Voice, QStringLiteral("Joe"));
+
+	// second pass uses cached formats
+	for(int i = 0; i < 2; i++) {
+		QCOMPARE(layout->applyCSS(cls).foreground().color(), QColor(0xff, 0, 0));
+		QCOMPARE(layout->applyCSS(bold).foreground().color(), QColor(0, 0, 0xff));
+		QCOMPARE(layout->applyCSS(bold).fontWeight(), int(QFont::Bold));
+		QVERIFY(layout->applyCSS(voice).fontItalic());
+		QVERIFY(!layout->applyCSS(QTextCharFormat()).hasProperty(QTextFormat::ForegroundBrush));
+	}
+
+	// changing stylesheet drops cached formats
+	css.parse(QStringLiteral(".red { color: #00ff00; }"));
+	QCOMPARE(layout->applyCSS(cls).foreground().color(), QColor(0, 0xff, 0));
+	css.clear();
+	QVERIFY(!layout->applyCSS(cls).hasProperty(QTextFormat::ForegroundBrush));
+}
+
 QTEST_MAIN(RichDocumentLayoutTest)
@@ -23,6 +23,7 @@ public:
 private slots:
 	void testMerge_data();
 	void testMerge();
+	void testApplyCSS();
 };
 
 #endif // RICHDOCUMENTLAYOUTTEST_H
@@ -344,4 +344,34 @@ RichStringTest::testStyleMerge()
 	QVERIFY(sstring.cummulativeVoices().size() == 1);
 }
 
+void
+RichStringTest::testStyleSpans()
+{
+	RichString sstring;
+	sstring.setRichString("<b>012</b><i>345</i>6789");
+
+	QVector<int> ends;
+	for(int i = 0; i < sstring.length(); i = sstring.styleSpanEnd(i))
+		ends.push_back(sstring.styleSpanEnd(i));
+	QCOMPARE(ends, QVector<int>({ 3, 6, 10 }));
+	QCOMPARE(sstring.styleSpanEnd(4), 6);
+
+	// neighbouring spans with same style are joined
+	sstring.setStyleFlags(3, 3, RichString::Bold);
+	QCOMPARE(sstring.styleSpanEnd(0), 6);
+	QVERIFY(sstring.richString() == QLatin1String("<b>012345</b>6789"));
+	sstring.setStyleFlags(0, 10, 0);
+	QCOMPARE(sstring.styleSpanEnd(0), 10);
+
+	// long text with few style changes
+	RichString longText(QString(10000, QChar('x')));
+	longText.setStyleFlags(5000, 10, RichString::Italic);
+	QCOMPARE(longText.styleSpanEnd(0), 5000);
+	QCOMPARE(longText.styleSpanEnd(5003), 5010);
+	QCOMPARE(longText.styleSpanEnd(5010), 10000);
+	longText.insert(5005, QStringLiteral("yy"));
+	QCOMPARE(longText.styleSpanEnd(5000), 5012);
+	QVERIFY(longText.styleFlagsAt(5006) == RichString::Italic);
+}
+
 QTEST_GUILESS_MAIN(RichStringTest);
@@ -20,6 +20,7 @@ private slots:
 	void testInsert();
 	void testReplace();
 	void testStyleMerge();
+	void testStyleSpans();
 };
 
 #endif
@@ -0,0 +1,75 @@
+/*
+    SPDX-FileCopyrightText: 2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef SUBRIPREFERENCE_H
+#define SUBRIPREFERENCE_H
+
+#include "core/subtitle.h"
+#include "core/subtitleline.h"
+#include "formats/subrip/subripinputformat.h"
+#include "helpers/common.h"
+
+#include <QRegularExpression>
+
+// shared by SubRip parser test and benchmark
+namespace SubtitleComposer {
+class SubRipInput : public SubRipInputFormat
+{
+public:
+	using SubRipInputFormat::parseSubtitles;
+};
+
+// regular expression based parser that was used before, kept as reference
+inline bool
+parseSubtitlesRegEx(Subtitle &subtitle, const QString &data)
+{
+	staticRE$(reTime, "[\\d]+\n([0-2][0-9]):([0-5][0-9]):([0-5][0-9])[,\\.]([0-9]+) --> ([0-2][0-9]):([0-5][0-9]):([0-5][0-9])[,\\.]([0-9]+)\n", REu);
+
+	QRegularExpressionMatchIterator itTime = reTime.globalMatch(data);
+	if(!itTime.hasNext())
+		return false;
+
+	SubtitleLineBatch batch(&subtitle);
+
+	do {
+		QRegularExpressionMatch mTime = itTime.next();
+
+		Time showTime(mTime.captured(1).toInt(), mTime.captured(2).toInt(), mTime.captured(3).toInt(), mTime.captured(4).toInt());
+		Time hideTime(mTime.captured(5).toInt(), mTime.captured(6).toInt(), mTime.captured(7).toInt(), mTime.captured(8).toInt());
+
+		const int off = mTime.capturedEnd();
+		const QString text = data.mid(off, itTime.hasNext() ? itTime.peekNext().capturedStart() - off : -1).trimmed();
+
+		RichString stext;
+		stext.setRichString(text);
+
+		SubtitleLine *line = new SubtitleLine(showTime, hideTime);
+		line->setPrimaryText(stext);
+		batch.append(line);
+	} while(itTime.hasNext());
+
+	batch.commit();
+	return true;
+}
+
+inline QString
+generateSubRip(int cues)
+{
+	QString data;
+	data.reserve(cues * 64);
+	for(int i = 0; i < cues; i++) {
+		const Time show(i * 1000.);
+		const Time hide(i * 1000. + 800.);
+		data.append(QString::number(i + 1)).append(QChar::LineFeed)
+			.append(show.toString().replace(QChar('.'), QChar(','))).append($(" --> "))
+			.append(hide.toString().replace(QChar('.'), QChar(','))).append(QChar::LineFeed)
+			.append($("Line <i>number</i> ")).append(QString::number(i + 1)).append($("\nsecond row\n\n"));
+	}
+	return data;
+}
+}
+
+#endif // SUBRIPREFERENCE_H
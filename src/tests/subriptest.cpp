@@ -0,0 +1,49 @@
+/*
+    SPDX-FileCopyrightText: 2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "subriptest.h"
+
+#include "subripreference.h"
+
+#include <QTest>
+
+using namespace SubtitleComposer;
+
+void
+SubRipTest::testParse_data()
+{
+	QTest::addColumn<QString>("data");
+
+	QTest::newRow("basic") << $("1\n00:00:01,000 --> 00:00:02,500\nHello\n\n2\n00:00:03,000 --> 00:00:04,000\n<b>World</b>\n");
+	QTest::newRow("dot millis") << $("1\n00:00:01.5 --> 00:00:02.25\nHello\n\n");
+	QTest::newRow("garbage before") << $("garbage 42\n1\n00:00:01,000 --> 00:00:02,500\nHello\n");
+	QTest::newRow("empty text") << $("1\n00:00:01,000 --> 00:00:02,000\n2\n00:00:03,000 --> 00:00:04,000\nText\n");
+	QTest::newRow("multiline") << $("1\n00:00:01,000 --> 00:00:02,000\n  First\nSecond  \n\n\n\n2\n00:00:03,000 --> 00:00:04,000\n- Dash\n- Dash\n");
+	QTest::newRow("bad timing") << $("1\n00:00:01,000 -> 00:00:02,000\nSkipped\n2\n00:00:03,000 --> 00:00:04,000\nText\n");
+	QTest::newRow("unicode number") << $("\u0661\u0662\n00:00:01,000 --> 00:00:02,000\nArabic-Indic\n\n\U0001D7CF\n00:00:03,000 --> 00:00:04,000\nMath bold\n");
+	QTest::newRow("generated") << generateSubRip(100);
+}
+
+void
+SubRipTest::testParse()
+{
+	QFETCH(QString, data);
+
+	QExplicitlySharedDataPointer<Subtitle> expected(new Subtitle());
+	QExplicitlySharedDataPointer<Subtitle> actual(new Subtitle());
+	QCOMPARE(SubRipInput().parseSubtitles(*actual, data), parseSubtitlesRegEx(*expected, data));
+
+	QCOMPARE(actual->count(), expected->count());
+	for(int i = 0; i < expected->count(); i++) {
+		const SubtitleLine *e = expected->at(i);
+		const SubtitleLine *a = actual->at(i);
+		QCOMPARE(a->showTime().toMillis(), e->showTime().toMillis());
+		QCOMPARE(a->hideTime().toMillis(), e->hideTime().toMillis());
+		QCOMPARE(a->primaryText().richString(), e->primaryText().richString());
+	}
+}
+
+QTEST_MAIN(SubRipTest);
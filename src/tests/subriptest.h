@@ -0,0 +1,21 @@
+/*
+    SPDX-FileCopyrightText: 2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef SUBRIPTEST_H
+#define SUBRIPTEST_H
+
+#include <QObject>
+
+class SubRipTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void testParse_data();
+	void testParse();
+};
+
+#endif // SUBRIPTEST_H
@@ -6,12 +6,21 @@
 
 #include "subtitletest.h"
 
+#include <QSignalSpy>
 #include <QTest>
+#include <QUndoStack>
 
 #include "core/richtext/richdocument.h"
+#include "core/undo/subtitleactions.h"
+#include "core/undo/subtitlelineactions.h"
+#include "core/undo/undomemorytracker.h"
+#include "scripting/scripting_subtitle.h"
+#include "scconfig.h"
 
 #include <klocalizedstring.h>
 
+#include <algorithm>
+
 using namespace SubtitleComposer;
 
 
@@ -59,4 +68,516 @@ SubtitleTest::testSort()
 		QVERIFY(qRound(sub->at(i)->showTime().toSeconds()) == i + 1);
 }
 
+void
+SubtitleTest::testSortLines_data()
+{
+	testSort_data();
+}
+
+void
+SubtitleTest::testSortLines()
+{
+	QFETCH(QVector<int>, lines);
+
+	sub->removeLines(RangeList(Range::full()), SubtitleTarget::Both);
+
+	// every time is used by two lines
+	const int n = lines.size() * 2;
+	{
+		SubtitleLineBatch batch(sub.data());
+		for(int i = 0; i < n; i++) {
+			SubtitleLine *l = new SubtitleLine((i / 2 + 1) * 1000, (i / 2 + 1) * 1000 + 500);
+			l->primaryDoc()->setPlainText(QString::number(i));
+			batch.append(l);
+		}
+	}
+	const auto lineNumber = [&](int index){ return sub->at(index)->primaryDoc()->toPlainText().toInt(); };
+
+	// lines with same time are swapped, so stable sort is distinguishable
+	QVector<int> permutation(n);
+	for(int i = 0; i < n; i++)
+		permutation[i] = (lines.at(i / 2) - 1) * 2 + 1 - (i & 1);
+
+	QScopedPointer<QUndoCommand> permute(new PermuteLinesAction(sub.data(), 0, permutation));
+	permute->redo();
+	for(int i = 0; i < n; i++) {
+		QCOMPARE(sub->at(i)->index(), i);
+		QCOMPARE(lineNumber(i), permutation.at(i));
+	}
+	permute->undo();
+	for(int i = 0; i < n; i++) {
+		QCOMPARE(sub->at(i)->index(), i);
+		QCOMPARE(lineNumber(i), i);
+	}
+
+	permute->redo();
+	sub->sortLines(Range::full());
+	for(int i = 0; i < n; i++) {
+		QCOMPARE(sub->at(i)->index(), i);
+		QCOMPARE(qRound(sub->at(i)->showTime().toSeconds()), i / 2 + 1);
+		QCOMPARE(lineNumber(i), i ^ 1);
+	}
+}
+
+void
+SubtitleTest::testTransformTimes()
+{
+	sub->removeLines(RangeList(Range::full()), SubtitleTarget::Both);
+	{
+		SubtitleLineBatch batch(sub.data());
+		for(int n = 1; n <= 10; n++)
+			batch.append(new SubtitleLine(n * 1000, n * 1000 + 500));
+	}
+	const auto verifyTimes = [&](double shift, double scale, int firstIndex = 0, int lastIndex = 9){
+		for(int i = 0; i < sub->count(); i++) {
+			const bool changed = i >= firstIndex && i <= lastIndex;
+			const double show = (i + 1) * 1000;
+			QCOMPARE(sub->at(i)->showTime().toMillis(), changed ? show * scale + shift : show);
+			QCOMPARE(sub->at(i)->hideTime().toMillis(), changed ? (show + 500) * scale + shift : show + 500);
+		}
+	};
+
+	QScopedPointer<QUndoCommand> transform(new TransformTimesAction(sub.data(), RangeList(Range(2, 5)), 250., 2.));
+	transform->redo();
+	verifyTimes(250., 2., 2, 5);
+	transform->undo();
+	verifyTimes(0., 1.);
+
+	sub->shiftLines(RangeList(Range::full()), 1500);
+	verifyTimes(1500., 1.);
+	sub->shiftLines(RangeList(Range::full()), -1500);
+	verifyTimes(0., 1.);
+
+	sub->adjustLines(Range::full(), 2000, 20000);
+	verifyTimes(0., 2.);
+	sub->adjustLines(Range::full(), 1000, 10000);
+	verifyTimes(0., 1.);
+
+	// times that would end up negative are clamped
+	sub->shiftLines(RangeList(Range::full()), -1200);
+	QCOMPARE(sub->at(0)->showTime().toMillis(), 0.);
+	QCOMPARE(sub->at(0)->hideTime().toMillis(), 300.);
+	QCOMPARE(sub->at(1)->showTime().toMillis(), 800.);
+
+	// undo restores exact times even when inverse transformation doesn't
+	// (fractional scale rounding and times clamped at zero)
+	sub->removeLines(RangeList(Range::full()), SubtitleTarget::Both);
+	{
+		SubtitleLineBatch batch(sub.data());
+		for(int n = 0; n < 10; n++)
+			batch.append(new SubtitleLine(n * 1007 + 7, n * 1007 + 507));
+	}
+	QScopedPointer<QUndoCommand> frameRate(new TransformTimesAction(sub.data(), RangeList(Range::full()), -1000.5, 25. / 23.976));
+	frameRate->redo();
+	QCOMPARE(sub->at(0)->showTime().toMillis(), 0.);
+	frameRate->undo();
+	for(int n = 0; n < 10; n++) {
+		QVERIFY(sub->at(n)->showTime().toMillis() == n * 1007 + 7);
+		QVERIFY(sub->at(n)->hideTime().toMillis() == n * 1007 + 507);
+	}
+}
+
+void
+SubtitleTest::testTimingPasses()
+{
+	sub->removeLines(RangeList(Range::full()), SubtitleTarget::Both);
+	{
+		SubtitleLineBatch batch(sub.data());
+		for(int n = 1; n <= 10; n++)
+			batch.append(new SubtitleLine(n * 1000, n * 1000 + (n % 2 ? 1200 : 100)));
+	}
+	const auto verifyMirror = [&](){
+		for(int i = 0; i < sub->count(); i++) {
+			QCOMPARE(sub->times().showTimes()[i], sub->at(i)->showTime().toMillis());
+			QCOMPARE(sub->times().hideTimes()[i], sub->at(i)->hideTime().toMillis());
+		}
+	};
+	verifyMirror();
+
+	sub->fixOverlappingLines(RangeList(Range::full()), 100);
+	verifyMirror();
+	for(int i = 0; i < 9; i++)
+		QVERIFY(sub->at(i)->hideTime().toMillis() + 100 <= sub->at(i + 1)->showTime().toMillis());
+
+	sub->applyDurationLimits(RangeList(Range::full()), 500, 600, false);
+	verifyMirror();
+	for(int i = 0; i < 10; i++) {
+		QVERIFY(sub->at(i)->durationTime().toMillis() >= 500);
+		QVERIFY(sub->at(i)->durationTime().toMillis() <= 600);
+	}
+
+	sub->setMaximumDurations(RangeList(Range::full()));
+	verifyMirror();
+	for(int i = 0; i < 9; i++)
+		QCOMPARE(sub->at(i)->hideTime().toMillis(), sub->at(i + 1)->showTime().toMillis() - 1);
+
+	sub->removeLines(RangeList(Range(2, 4)), SubtitleTarget::Both);
+	sub->insertNewLine(3, false, SubtitleTarget::Both);
+	verifyMirror();
+}
+
+void
+SubtitleTest::testLineBatch_data()
+{
+	testSort_data();
+}
+
+void
+SubtitleTest::testLineBatch()
+{
+	QFETCH(QVector<int>, lines);
+
+	sub->removeLines(RangeList(Range::full()), SubtitleTarget::Both);
+
+	{
+		SubtitleLineBatch batch(sub.data(), lines.size());
+		for(int n: lines) {
+			SubtitleLine *l = new SubtitleLine(n * 1000, n * 1000 + 500);
+			l->primaryDoc()->setPlainText(QString::number(n));
+			batch.append(l);
+		}
+		QVERIFY(batch.count() == lines.size());
+		QVERIFY(sub->count() == 0);
+	}
+
+	QVERIFY(sub->count() == lines.size());
+	for(int i = 0; i < sub->count(); i++) {
+		QVERIFY(qRound(sub->at(i)->showTime().toSeconds()) == i + 1);
+		QVERIFY(sub->at(i)->index() == i);
+	}
+
+	// batch that interleaves with existing lines
+	SubtitleLineBatch batch(sub.data());
+	for(int n: lines)
+		batch.append(new SubtitleLine(n * 1000 + 100, n * 1000 + 600));
+	batch.commit();
+
+	QVERIFY(sub->count() == lines.size() * 2);
+	for(int i = 1; i < sub->count(); i++)
+		QVERIFY(sub->at(i - 1)->showTime() <= sub->at(i)->showTime());
+}
+
+void
+SubtitleTest::testCompactText()
+{
+	QExplicitlySharedDataPointer<Subtitle> subtitle(new Subtitle());
+	const RichString text = RichString::fromRichString(QStringLiteral("<b>Bold</b> and\u00a0plain\nsecond line"));
+
+	SubtitleLine *line = new SubtitleLine(1000, 2000);
+	line->setPrimaryText(text);
+	QVERIFY(!line->hasDoc(true));
+	QVERIFY(!line->hasDoc(false));
+	QVERIFY(line->compactMemorySaved() >= 2 * SubtitleLine::documentMemoryUsage());
+	QCOMPARE(line->primaryText().richString(), text.richString());
+	QCOMPARE(line->primaryPlainText(), QStringLiteral("Bold and plain\nsecond line"));
+	QCOMPARE(line->primaryLines(), 2);
+	QVERIFY(line->secondaryText().isEmpty());
+	QVERIFY(line->checkEmptySecondaryText(false));
+
+	subtitle->insertLine(line);
+	QVERIFY(!line->hasDoc(true));
+	QCOMPARE(subtitle->compactMemorySaved(), qint64(line->compactMemorySaved()));
+
+	// document is created on first access and contains the same text
+	RichDocument *doc = line->primaryDoc();
+	QVERIFY(line->hasDoc(true));
+	QCOMPARE(doc->toRichText().richString(), text.richString());
+	QCOMPARE(doc->toPlainText(), QStringLiteral("Bold and plain\nsecond line"));
+	QCOMPARE(line->compactMemorySaved(), SubtitleLine::documentMemoryUsage());
+
+	// compact texts are moved out of other subtitle, but copied within the same line
+	QExplicitlySharedDataPointer<Subtitle> source(new Subtitle());
+	SubtitleLine *sourceLine = new SubtitleLine(1000, 2000);
+	sourceLine->setPrimaryText(text);
+	source->insertLine(sourceLine);
+	QExplicitlySharedDataPointer<Subtitle> target(new Subtitle());
+	target->setSecondaryData(*source, true);
+	QCOMPARE(target->count(), 1);
+	QCOMPARE(target->at(0)->secondaryText().richString(), text.richString());
+	QVERIFY(!target->at(0)->hasDoc(false));
+	QVERIFY(sourceLine->primaryText().isEmpty());
+
+	SubtitleLine *bothLine = new SubtitleLine(1000, 2000);
+	bothLine->setPrimaryText(text);
+	source->insertLine(bothLine);
+	source->setSecondaryData(*source, true);
+	QCOMPARE(bothLine->primaryText().richString(), text.richString());
+	QCOMPARE(bothLine->secondaryText().richString(), text.richString());
+	QVERIFY(!bothLine->hasDoc(true));
+	QVERIFY(!bothLine->hasDoc(false));
+}
+
+void
+SubtitleTest::testTimeIndex()
+{
+	QExplicitlySharedDataPointer<Subtitle> subtitle(new Subtitle());
+
+	const auto overlapping = [&](double start, double end){
+		QVector<SubtitleLine *> lines;
+		for(int i = 0; i < subtitle->count(); i++) {
+			if(subtitle->at(i)->intersectsTimespan(start, end))
+				lines.push_back(subtitle->at(i));
+		}
+		std::stable_sort(lines.begin(), lines.end(), [](const SubtitleLine *l1, const SubtitleLine *l2){
+			return l1->showTime() < l2->showTime();
+		});
+		return lines;
+	};
+	const auto verifyAll = [&](){
+		for(int t = 0; t < 12000; t += 250) {
+			QCOMPARE(subtitle->linesInTimespan(t, t), overlapping(t, t));
+			QCOMPARE(subtitle->linesInTimespan(t, t + 1500), overlapping(t, t + 1500));
+		}
+	};
+
+	QVERIFY(subtitle->linesInTimespan(0, 10000).isEmpty());
+
+	// long line overlaps many short ones
+	{
+		SubtitleLineBatch batch(subtitle.data());
+		batch.append(new SubtitleLine(500, 9000));
+		for(int n = 1; n <= 10; n++)
+			batch.append(new SubtitleLine(n * 1000, n * 1000 + 700));
+	}
+	verifyAll();
+	QCOMPARE(subtitle->linesInTimespan(5200, 5200).size(), 2);
+
+	// times that keep lines order are updated in place
+	subtitle->at(3)->setHideTime(11000);
+	subtitle->at(4)->setShowTime(3900);
+	verifyAll();
+
+	// times that change lines order
+	subtitle->at(1)->setTimes(7500, 7800);
+	verifyAll();
+	subtitle->sortLines(Range::full());
+	verifyAll();
+
+	subtitle->removeLines(RangeList(Range(2, 4)), SubtitleTarget::Both);
+	verifyAll();
+}
+
+void
+SubtitleTest::testLineTextActions()
+{
+	QExplicitlySharedDataPointer<Subtitle> subtitle(new Subtitle());
+	SubtitleLine *line = new SubtitleLine(1000, 2000);
+	subtitle->insertLine(line);
+
+	const RichString before = RichString::fromRichString(QStringLiteral("Some <b>bold</b> text\n").repeated(100).trimmed());
+	RichString after(before);
+	after.insert(500, RichString(QStringLiteral("inserted"), RichString::Italic));
+	line->setPrimaryText(after);
+
+	// only changed part of the text is kept
+	QScopedPointer<QUndoCommand> action(new SetLinePrimaryTextAction(line, before, after));
+	QVERIFY(UndoMemoryTracker::commandMemoryUsage(action.data()) < before.memoryUsage() / 4);
+
+	// text has already changed, so first redo does nothing
+	action->redo();
+	QCOMPARE(line->primaryText().richString(), after.richString());
+	action->undo();
+	QCOMPARE(line->primaryText().richString(), before.richString());
+	QCOMPARE(line->primaryDoc()->toRichText().richString(), before.richString());
+	action->redo();
+	QCOMPARE(line->primaryText().richString(), after.richString());
+	action->undo();
+
+	// consecutive typing is merged
+	const RichString a(QStringLiteral("a")), ab(QStringLiteral("ab")), abc(QStringLiteral("abc"));
+	line->setSecondaryText(abc);
+	QScopedPointer<QUndoCommand> typing(new SetLineSecondaryTextAction(line, a, ab));
+	QScopedPointer<QUndoCommand> typingNext(new SetLineSecondaryTextAction(line, ab, abc));
+	QScopedPointer<QUndoCommand> typingElsewhere(new SetLineSecondaryTextAction(line, abc, RichString(QStringLiteral("xabc"))));
+	QVERIFY(typing->mergeWith(typingNext.data()));
+	QVERIFY(!typing->mergeWith(typingElsewhere.data()));
+	typing->undo();
+	QCOMPARE(line->secondaryText().richString(), a.richString());
+	typing->redo();
+	QCOMPARE(line->secondaryText().richString(), abc.richString());
+	QCOMPARE(line->primaryText().richString(), before.richString());
+}
+
+void
+SubtitleTest::testUndoMemoryLimit()
+{
+	QExplicitlySharedDataPointer<Subtitle> subtitle(new Subtitle());
+	{
+		SubtitleLineBatch batch(subtitle.data());
+		for(int i = 0; i < 30; i++) {
+			SubtitleLine *line = new SubtitleLine(i * 1000, i * 1000 + 500);
+			line->setPrimaryText(RichString(QStringLiteral("Line %1").arg(i)));
+			batch.append(line);
+		}
+	}
+	for(int i = 0; i < subtitle->count(); i++)
+		subtitle->at(i)->primaryDoc();
+
+	QUndoStack stack;
+	UndoMemoryTracker tracker(&stack);
+	QObject context; // stack is cleared when destroyed, tracker will be gone by then
+	QObject::connect(&stack, &QUndoStack::indexChanged, &context, [&](int idx){ tracker.indexChanged(idx); });
+
+	for(int i = 0; i < 3; i++)
+		stack.push(new RemoveLinesAction(subtitle.data(), 0, 9));
+	QCOMPARE(subtitle->count(), 0);
+
+	size_t usage = 0;
+	for(int i = 0; i < stack.count(); i++)
+		usage += UndoMemoryTracker::commandMemoryUsage(stack.command(i));
+	QCOMPARE(tracker.memoryUsage(), usage);
+	QVERIFY(usage >= 30 * size_t(SubtitleLine::documentMemoryUsage()));
+
+	// within limit nothing changes
+	tracker.applyLimit(0);
+	tracker.applyLimit(usage);
+	QCOMPARE(tracker.memoryUsage(), usage);
+
+	// oldest command is compacted first, everything can still be undone
+	tracker.applyLimit(usage - 1);
+	QVERIFY(tracker.memoryUsage() < usage);
+	QCOMPARE(tracker.floor(), 0);
+	QVERIFY(UndoMemoryTracker::commandMemoryUsage(stack.command(0)) < UndoMemoryTracker::commandMemoryUsage(stack.command(1)));
+
+	// then released up to the most recent command, which can still be undone
+	tracker.applyLimit(1);
+	QCOMPARE(tracker.floor(), stack.count() - 1);
+	for(int i = 0; i < tracker.floor(); i++)
+		QVERIFY(UndoMemoryTracker::commandMemoryUsage(stack.command(i)) < UndoMemoryTracker::commandMemoryUsage(stack.command(tracker.floor())));
+
+	stack.undo();
+	QCOMPARE(subtitle->count(), 10);
+	for(int i = 0; i < subtitle->count(); i++) {
+		QVERIFY(!subtitle->at(i)->hasDoc(true));
+		QCOMPARE(subtitle->at(i)->primaryText().string(), QStringLiteral("Line %1").arg(i + 20));
+	}
+}
+
+void
+SubtitleTest::testCheckText_data()
+{
+	QTest::addColumn<QString>("primary");
+	QTest::addColumn<QString>("secondary");
+	QTest::addColumn<double>("duration");
+	QTest::addColumn<int>("errors");
+
+	// 30 and 29 characters, 3s is within duration per character limits for both
+	const QString p = QStringLiteral("Hello there, how are you today");
+	const QString s = QStringLiteral("Hola amigo, como estas tu hoy");
+	const QString longLines = QString(45, QChar('a')) + QChar('\n') + QString(45, QChar('b'));
+	const QString longLine = QString(41, QChar('a'));
+
+	QTest::newRow("clean") << p << s << 3000. << 0;
+	QTest::newRow("empty primary") << QString() << s << 3000. << int(SubtitleLine::EmptyPrimaryText);
+	QTest::newRow("empty secondary") << p << QString() << 3000. << int(SubtitleLine::EmptySecondaryText);
+	QTest::newRow("untranslated") << p << p << 3000. << int(SubtitleLine::UntranslatedText);
+	QTest::newRow("min duration primary") << p << QStringLiteral("Hola amigo") << 800. << int(SubtitleLine::MinDurationPerPrimaryChar);
+	QTest::newRow("min duration secondary") << QStringLiteral("Hello there") << s << 800. << int(SubtitleLine::MinDurationPerSecondaryChar);
+	QTest::newRow("max duration primary") << QStringLiteral("Hi") << s << 3000. << int(SubtitleLine::MaxDurationPerPrimaryChar);
+	QTest::newRow("max duration secondary") << p << QStringLiteral("Hola") << 3000. << int(SubtitleLine::MaxDurationPerSecondaryChar);
+	QTest::newRow("max chars primary") << longLines << s << 3000. << int(SubtitleLine::MaxPrimaryChars | SubtitleLine::MaxPrimaryCharsPerLine);
+	QTest::newRow("max chars secondary") << p << longLines << 3000. << int(SubtitleLine::MaxSecondaryChars | SubtitleLine::MaxSecondaryCharsPerLine);
+	QTest::newRow("max chars per line primary") << longLine << s << 3000. << int(SubtitleLine::MaxPrimaryCharsPerLine);
+	QTest::newRow("max chars per line secondary") << p << longLine << 3000. << int(SubtitleLine::MaxSecondaryCharsPerLine);
+	QTest::newRow("max lines primary") << QStringLiteral("One\nTwo\nThree") << s << 1000. << int(SubtitleLine::MaxPrimaryLines);
+	QTest::newRow("max lines secondary") << p << QStringLiteral("Uno\nDos\nTres") << 1000. << int(SubtitleLine::MaxSecondaryLines);
+	QTest::newRow("spaces primary") << QStringLiteral("Hello there , how are you today") << s << 3000. << int(SubtitleLine::PrimaryUnneededSpaces);
+	QTest::newRow("spaces secondary") << p << QStringLiteral("Hola amigo , como estas tu hoy") << 3000. << int(SubtitleLine::SecondaryUnneededSpaces);
+	QTest::newRow("ellipsis primary") << QStringLiteral("...Hello there, how are you") << s << 3000. << int(SubtitleLine::PrimaryCapitalAfterEllipsis);
+	QTest::newRow("ellipsis secondary") << p << QStringLiteral("...Hola amigo, como estas") << 3000. << int(SubtitleLine::SecondaryCapitalAfterEllipsis);
+	QTest::newRow("dash primary") << QStringLiteral("- Hello there\nhow are you today") << s << 3000. << int(SubtitleLine::PrimaryUnneededDash);
+	QTest::newRow("dash secondary") << p << QStringLiteral("- Hola amigo\ncomo estas tu hoy") << 3000. << int(SubtitleLine::SecondaryUnneededDash);
+}
+
+void
+SubtitleTest::testCheckText()
+{
+	QFETCH(QString, primary);
+	QFETCH(QString, secondary);
+	QFETCH(double, duration);
+	QFETCH(int, errors);
+
+	SCConfig::setMaxCharacters(80);
+	SCConfig::setMaxLines(2);
+	SCConfig::setMaxCharactersPerLine(40);
+	SCConfig::setMinDurationPerCharacter(30);
+	SCConfig::setMaxDurationPerCharacter(185);
+
+	SubtitleLine::TextSnapshot text;
+	text.primary = primary;
+	text.secondary = secondary;
+	text.duration = duration;
+	QCOMPARE(SubtitleLine::checkText(text, SubtitleLine::TextErrors), errors);
+
+	// line check goes through the same path with texts taken from the line
+	SubtitleLine line(1000., 1000. + duration);
+	line.setPrimaryText(RichString(primary));
+	line.setSecondaryText(RichString(secondary));
+	QCOMPARE(line.check(SubtitleLine::TextErrors, false) & SubtitleLine::TextErrors, errors);
+}
+
+void
+SubtitleTest::testTextMetrics()
+{
+	QExplicitlySharedDataPointer<Subtitle> subtitle(new Subtitle());
+
+	SubtitleLine *line = new SubtitleLine(1000, 2000);
+	line->setPrimaryText(RichString(QStringLiteral("One  two\nthree")));
+	QCOMPARE(line->primaryCharacters(), 13);
+	QCOMPARE(line->primaryWords(), 3);
+	QCOMPARE(line->primaryLines(), 2);
+	QCOMPARE(line->textMetrics(true).maxLineCharacters, 7);
+
+	// cached metrics follow changes of compact text and of the document
+	line->setPrimaryText(RichString(QStringLiteral("One")));
+	QCOMPARE(line->primaryWords(), 1);
+	QCOMPARE(line->primaryLines(), 1);
+
+	subtitle->insertLine(line);
+	line->primaryDoc()->setPlainText(QStringLiteral("One two three four"));
+	QCOMPARE(line->primaryWords(), 4);
+	QCOMPARE(line->textMetrics(true).maxLineCharacters, 18);
+	QCOMPARE(line->secondaryCharacters(), 0);
+}
+
+void
+SubtitleTest::testScriptingBulkAccess()
+{
+	QExplicitlySharedDataPointer<Subtitle> subtitle(new Subtitle());
+	for(int i = 0; i < 5; i++) {
+		SubtitleLine *line = new SubtitleLine(i * 1000., i * 1000. + 500.);
+		line->setPrimaryText(RichString::fromRichString(QStringLiteral("<b>Line</b> %1").arg(i)));
+		subtitle->insertLine(line);
+	}
+	Scripting::Subtitle s(subtitle.data(), nullptr);
+
+	// ranges are clamped to existing lines
+	QCOMPARE(s.showTimes(1, 3), QVariantList({ 1000, 2000, 3000 }));
+	QCOMPARE(s.hideTimes(3), QVariantList({ 3500, 4500 }));
+	QCOMPARE(s.plainTexts(4, 10, Primary), QVariantList({ QStringLiteral("Line 4") }));
+	QCOMPARE(s.richTexts(0, 0, Primary), QVariantList({ QStringLiteral("<b>Line</b> 0") }));
+	QVERIFY(s.richTexts(3, 1, Primary).isEmpty());
+
+	QSignalSpy composites(subtitle.data(), &Subtitle::compositeActionStart);
+
+	// negative index changes nothing
+	s.setTimes(-1, { 0, 0 }, { 100, 100 });
+	s.setRichTexts(-1, { QStringLiteral("x"), QStringLiteral("y") }, Primary);
+	QCOMPARE(composites.count(), 0);
+	QCOMPARE(subtitle->line(0)->showTime().toMillis(), 0.);
+	QCOMPARE(subtitle->line(0)->primaryText().richString(), QStringLiteral("<b>Line</b> 0"));
+
+	// each bulk write is a single composite action, extra values are ignored
+	s.setRichTexts(3, { QStringLiteral("<i>Three</i>"), QVariant(), QStringLiteral("Extra") }, Primary);
+	QCOMPARE(composites.count(), 1);
+	QCOMPARE(subtitle->line(3)->primaryText().richString(), QStringLiteral("<i>Three</i>"));
+	QCOMPARE(subtitle->line(4)->primaryText().richString(), QStringLiteral("<b>Line</b> 4"));
+	QCOMPARE(subtitle->count(), 5);
+
+	s.setTimes(1, { 1100, 2100 }, { 1600 });
+	QCOMPARE(composites.count(), 2);
+	QCOMPARE(s.showTimes(0, 3), QVariantList({ 0, 1100, 2100, 3000 }));
+	QCOMPARE(s.hideTimes(0, 3), QVariantList({ 500, 1600, 2500, 3500 }));
+}
+
 QTEST_MAIN(SubtitleTest);
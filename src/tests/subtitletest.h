@@ -22,6 +22,20 @@ public:
 private slots:
 	void testSort_data();
 	void testSort();
+	void testSortLines_data();
+	void testSortLines();
+	void testTransformTimes();
+	void testTimingPasses();
+	void testLineBatch_data();
+	void testLineBatch();
+	void testCompactText();
+	void testTimeIndex();
+	void testLineTextActions();
+	void testUndoMemoryLimit();
+	void testCheckText_data();
+	void testCheckText();
+	void testTextMetrics();
+	void testScriptingBulkAccess();
 
 private:
 	QExplicitlySharedDataPointer<SubtitleComposer::Subtitle> sub;
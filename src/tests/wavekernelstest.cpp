@@ -0,0 +1,73 @@
+/*
+    SPDX-FileCopyrightText: 2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "wavekernelstest.h"
+
+#include "gui/waveform/wavekernels.h"
+
+#include <QTest>
+
+using namespace SubtitleComposer;
+
+Q_DECLARE_METATYPE(const WaveKernels *)
+
+namespace {
+QVector<qint16>
+generateSamples(int count)
+{
+	QVector<qint16> samples(count);
+	quint32 seed = count;
+	for(qint16 &s: samples) {
+		seed = seed * 1103515245 + 12345;
+		s = qint16(seed >> 16);
+	}
+	// make sure extremes are covered
+	samples[1] = 32767;
+	samples[2] = -32768;
+	samples[3] = -1;
+	return samples;
+}
+}
+
+void
+WaveKernelsTest::testKernels_data()
+{
+	QTest::addColumn<const WaveKernels *>("kernels");
+
+	for(const WaveKernels *k: WaveKernels::available())
+		QTest::newRow(k->name) << k;
+}
+
+void
+WaveKernelsTest::testKernels()
+{
+	QFETCH(const WaveKernels *, kernels);
+
+	const QVector<qint16> samples = generateSamples(1000003);
+	const WaveKernels *scalar = WaveKernels::available().first();
+
+	for(const int offset: {0, 3, 8}) {
+		const quint32 blocks = (samples.size() - offset) >> WaveKernels::BlockShift;
+		QVector<WavePeak> expected(blocks), actual(blocks);
+		scalar->reduceBlocks(samples.constData() + offset, blocks, expected.data());
+		kernels->reduceBlocks(samples.constData() + offset, blocks, actual.data());
+		for(quint32 i = 0; i < blocks; i++) {
+			QCOMPARE(actual[i].avg, expected[i].avg);
+			QCOMPARE(actual[i].max, expected[i].max);
+		}
+
+		for(const quint32 count: {0U, 1U, 7U, 15U, 16U, 17U, 1000U, quint32(samples.size() - offset)}) {
+			quint64 expectedSum = 0, actualSum = 0;
+			quint32 expectedMax = 0, actualMax = 0;
+			scalar->reduceRange(samples.constData() + offset, count, &expectedSum, &expectedMax);
+			kernels->reduceRange(samples.constData() + offset, count, &actualSum, &actualMax);
+			QCOMPARE(actualSum, expectedSum);
+			QCOMPARE(actualMax, expectedMax);
+		}
+	}
+}
+
+QTEST_GUILESS_MAIN(WaveKernelsTest);
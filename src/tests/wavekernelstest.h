@@ -0,0 +1,21 @@
+/*
+    SPDX-FileCopyrightText: 2022 Mladen Milinkovic <max@smoothware.net>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef WAVEKERNELSTEST_H
+#define WAVEKERNELSTEST_H
+
+#include <QObject>
+
+class WaveKernelsTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void testKernels_data();
+	void testKernels();
+};
+
+#endif // WAVEKERNELSTEST_H
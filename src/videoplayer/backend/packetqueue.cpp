@@ -7,6 +7,7 @@
 
 #include "packetqueue.h"
 
+#include <QElapsedTimer>
 #include <QMutex>
 #include <QWaitCondition>
 
@@ -17,13 +18,15 @@ using namespace SubtitleComposer;
 PacketQueue::PacketQueue()
 	: m_firstPkt(nullptr),
 	  m_lastPkt(nullptr),
+	  m_freePkt(nullptr),
 	  m_nbPackets(0),
 	  m_size(0),
 	  m_duration(0),
 	  m_abortRequest(false),
 	  m_serial(0),
 	  m_mutex(nullptr),
-	  m_cond(nullptr)
+	  m_cond(nullptr),
+	  m_waiting(0)
 {
 }
 
@@ -37,7 +40,11 @@ PacketQueue::put_private(AVPacket **pkt)
 		return -1;
 	}
 
-	PacketList *pkt1 = new PacketList();
+	PacketList *pkt1 = m_freePkt;
+	if(pkt1)
+		m_freePkt = pkt1->next;
+	else
+		pkt1 = new PacketList();
 	pkt1->pkt = *pkt;
 	*pkt = nullptr;
 
@@ -54,8 +61,11 @@ PacketQueue::put_private(AVPacket **pkt)
 	m_nbPackets++;
 	m_size += pkt1->pkt->size + sizeof(*pkt1);
 	m_duration += pkt1->pkt->duration;
+	if(m_nbPackets > m_stats.maxPackets)
+		m_stats.maxPackets = m_nbPackets;
 	// XXX: should duplicate packet data in DV case
-	m_cond->wakeOne();
+	if(m_waiting)
+		m_cond->wakeOne();
 	return 0;
 }
 
@@ -88,9 +98,11 @@ PacketQueue::putNullPacket(int streamIndex)
 int
 PacketQueue::init()
 {
-	m_firstPkt = m_lastPkt = nullptr;
+	m_firstPkt = m_lastPkt = m_freePkt = nullptr;
 	m_nbPackets = m_size = m_serial = 0;
 	m_duration = 0;
+	m_waiting = 0;
+	m_stats = Stats();
 	m_mutex = new QMutex();
 	m_cond = new QWaitCondition();
 	m_abortRequest = true;
@@ -101,11 +113,11 @@ void
 PacketQueue::flush()
 {
 	QMutexLocker l(m_mutex);
-	PacketList *pkt, *pkt1;
-	for(pkt = m_firstPkt; pkt; pkt = pkt1) {
-		pkt1 = pkt->next;
+	for(PacketList *pkt = m_firstPkt; pkt; pkt = pkt->next)
 		av_packet_free(&pkt->pkt);
-		delete pkt;
+	if(m_lastPkt) {
+		m_lastPkt->next = m_freePkt;
+		m_freePkt = m_firstPkt;
 	}
 	m_lastPkt = nullptr;
 	m_firstPkt = nullptr;
@@ -118,6 +130,12 @@ void
 PacketQueue::destroy()
 {
 	flush();
+	PacketList *pkt, *pkt1;
+	for(pkt = m_freePkt; pkt; pkt = pkt1) {
+		pkt1 = pkt->next;
+		delete pkt;
+	}
+	m_freePkt = nullptr;
 	delete m_mutex;
 	delete m_cond;
 }
@@ -161,14 +179,28 @@ PacketQueue::get(AVPacket **pkt, int block, int *serial)
 			*pkt = pkt1->pkt;
 			if(serial)
 				*serial = pkt1->serial;
-			delete pkt1;
+			pkt1->next = m_freePkt;
+			m_freePkt = pkt1;
 			return 1;
 		}
 
 		if(!block)
 			return 0;
 
+		QElapsedTimer waitTimer;
+		waitTimer.start();
+		m_waiting++;
 		m_cond->wait(m_mutex);
+		m_waiting--;
+		m_stats.waits++;
+		m_stats.waitTime += waitTimer.nsecsElapsed() / 1000;
 	}
 }
 
+PacketQueue::Stats
+PacketQueue::stats() const
+{
+	QMutexLocker l(m_mutex);
+	return m_stats;
+}
+
@@ -21,6 +21,12 @@ namespace SubtitleComposer {
 class PacketQueue
 {
 public:
+	struct Stats {
+		int maxPackets = 0; // highest number of queued packets
+		int waits = 0; // times get() blocked on empty queue
+		qint64 waitTime = 0; // total time get() spent blocked (usec)
+	};
+
 	PacketQueue();
 
 	/**
@@ -51,6 +57,8 @@ public:
 	inline bool abortRequested() const { return m_abortRequest; }
 	inline int serial() const { return m_serial; }
 
+	Stats stats() const;
+
 private:
 	int put_private(AVPacket **pkt);
 
@@ -62,6 +70,8 @@ private:
 	};
 
 	PacketList *m_firstPkt, *m_lastPkt;
+	// nodes of dequeued packets are reused, they are allocated only while queue grows
+	PacketList *m_freePkt;
 	int m_nbPackets;
 	int m_size;
 	int64_t m_duration;
@@ -69,6 +79,8 @@ private:
 	int m_serial;
 	QMutex *m_mutex;
 	QWaitCondition *m_cond;
+	int m_waiting;
+	Stats m_stats;
 
 	friend class Decoder;
 	friend class FrameQueue;
@@ -108,6 +108,16 @@ StreamDemuxer::close(VideoState *vs)
 
 	avformat_close_input(&vs->fmtContext);
 
+	const auto logQueueStats = [](const char *name, const PacketQueue &pq){
+		const PacketQueue::Stats stats = pq.stats();
+		if(stats.maxPackets)
+			av_log(nullptr, AV_LOG_VERBOSE, "%s packet queue: max %d packets, decoder waited %d times for %lld ms\n",
+				   name, stats.maxPackets, stats.waits, (long long)(stats.waitTime / 1000));
+	};
+	logQueueStats("Video", vs->vidPQ);
+	logQueueStats("Audio", vs->audPQ);
+	logQueueStats("Subtitle", vs->subPQ);
+
 	vs->vidPQ.destroy();
 	vs->audPQ.destroy();
 	vs->subPQ.destroy();